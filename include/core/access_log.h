@@ -0,0 +1,110 @@
+#ifndef CORE_ACCESS_LOG_H
+#define CORE_ACCESS_LOG_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "utils/file_descriptor.h"
+
+// 访问日志参数
+struct AccessLogOptions {
+    std::string path_prefix;           // 文件名前缀（如 logs/access），文件名为 <前缀>_YYYYMMDD-HHMMSS[_序号].bin；为空表示不记录
+    size_t max_file_bytes = 67108864;  // 单个文件的大小上限，写满后轮换到新文件
+};
+
+// 一次请求的访问信息
+struct AccessEntry {
+    uint32_t client_ip = 0;                // 客户端 IPv4 地址（网络字节序）
+    uint16_t client_port = 0;              // 客户端端口
+    std::string_view method;               // 请求方法
+    std::string_view target;               // 请求目标（含查询字符串）
+    uint16_t status = 0;                   // 响应状态码
+    uint64_t bytes = 0;                    // 响应字节数
+    std::chrono::microseconds latency{0};  // 从读到请求到响应进入输出队列的耗时
+};
+
+// 前向声明
+class Logger;
+
+// 二进制访问日志（格式见 utils/access_log_format.h）：每个请求写入一条 40 字节的定长记录，方法与路径按文件内编号引用，
+// 时间按与上一条记录的差值编码。每个线程持有独立的写入器（文件、映射与字符串编号表），文件按 max_file_bytes 预分配
+// 并以共享内存映射写入，写入只是一次不加锁的内存拷贝，不经过格式化与系统调用；写满后由该线程截断到实际长度并轮换到新文件。
+// 由 AccessLogDecode 工具离线解码为文本、CSV 或 JSON
+class AccessLog {
+public:
+    // 创建第一个写入器的日志文件（检查前缀所在目录是否可写），失败时抛出异常
+    AccessLog(const AccessLogOptions& options, Logger* logger);
+
+    // 析构函数：将所有写入器的当前文件截断到已写入的长度（须在所有记录线程停止后调用）
+    ~AccessLog();
+
+    AccessLog(const AccessLog&) = delete;
+    AccessLog& operator=(const AccessLog&) = delete;
+    AccessLog(AccessLog&&) = delete;
+    AccessLog& operator=(AccessLog&&) = delete;
+
+    // 写入一条访问记录（线程安全，只写入本线程的写入器，不加锁）
+    void record(const AccessEntry& entry);
+
+    // 已写入与因无法写入而丢弃的记录数（汇总所有写入器）
+    [[nodiscard]] uint64_t recordCount() const;
+    [[nodiscard]] uint64_t droppedCount() const;
+
+private:
+    // 字符串编号表的哈希（支持以 string_view 查找，避免每次查找都构造 std::string）
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(const std::string_view value) const { return std::hash<std::string_view>{}(value); }
+    };
+
+    // 一个线程的写入器：只由持有它的线程访问，线程退出后由新线程接管并继续写入同一文件；
+    // 计数为单写者，其他线程可随时读取。按缓存行对齐避免写入器之间的伪共享
+    // NOLINTNEXTLINE(readability-magic-numbers, cppcoreguidelines-avoid-magic-numbers)
+    struct alignas(64) Writer {
+        FileDescriptor file;
+        std::string filename;
+        char* data = nullptr;      // 当前文件的映射（为空表示文件不可用，记录被丢弃）
+        size_t offset = 0;         // 已写入的字节数
+        int64_t last_time_us = 0;  // 上一条请求记录（或时间基准）的时间
+
+        // 当前文件中已写入的字符串及其编号（轮换时清空）
+        std::unordered_map<std::string, uint32_t, StringHash, std::equal_to<>> strings;
+
+        std::atomic<uint64_t> records{0};  // 已写入的记录数
+        std::atomic<uint64_t> dropped{0};  // 丢弃的记录数
+        std::atomic<bool> in_use{false};   // 是否有线程持有
+    };
+
+    AccessLogOptions options_;
+    Logger* logger_;
+    const uint64_t instance_id_;  // 实例编号，线程缓存的写入器据此判断归属
+
+    mutable std::mutex mutex_;                      // 只保护 writers_ 的登记与遍历，写入记录时不持有
+    std::vector<std::shared_ptr<Writer>> writers_;  // 所有写入器（只增不减）
+
+    // 获取当前线程的写入器，首次调用时接管一个空闲写入器，没有时在锁外创建新文件后登记
+    Writer& threadWriter();
+
+    // 为写入器创建并映射一个新文件，写入文件头；失败时抛出异常
+    void openFile(Writer& writer, int64_t now_us) const;
+
+    // 截断写入器的当前文件到已写入的长度并解除映射
+    void closeFile(Writer& writer) const;
+
+    // 返回字符串的编号，首次出现时先写入一条 STRING 记录（调用前已保证空间足够）
+    static uint32_t intern(Writer& writer, std::string_view value);
+
+    // 在写入器的当前位置写入 length 字节并补齐到 8 字节
+    static void append(Writer& writer, const void* data, size_t length);
+};
+
+#endif  // CORE_ACCESS_LOG_H
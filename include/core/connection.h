@@ -2,21 +2,43 @@
 #define CORE_CONNECTION_H
 
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
 
 #include <netinet/in.h>
+#include <sys/epoll.h>
 
 #include "core/address.h"
+#include "core/http_parser.h"
+#include "core/output_buffer.h"
 
 // 前向声明
+class AccessLog;
 class EpollManager;
 class Logger;
+class Metrics;
 class StaticFile;
 
+// 连接相关的可配置参数
+struct ConnectionOptions {
+    bool linger = false;                // 是否启用 linger 模式
+    size_t keepalive_max_requests = 0;  // 单个长连接最多处理的请求数（0 表示不限制）
+    int keepalive_timeout = 0;          // 长连接空闲超时秒数（0 表示禁用长连接）
+    size_t max_header_bytes = 8192;     // 请求行 + 头部允许的最大字节数
+    size_t max_body_bytes = 1048576;    // 请求正文允许的最大字节数
+    bool one_shot = false;              // 是否以 EPOLLONESHOT 注册（多线程处理同一 epoll 时使用）
+    bool serve_metrics = false;         // 是否在本端口的指标路径提供指标（未配置独立的指标端口时）
+};
+
 class Connection {
 public:
+    // access_log 为空时不记录访问日志，metrics 为空时不统计运行时指标
     Connection(int client_fd, const sockaddr_in& addr, EpollManager* epoll, Logger* logger, StaticFile* static_file,
-               bool linger = false);
+               AccessLog* access_log, Metrics* metrics, const ConnectionOptions& options);
     ~Connection();
 
     Connection(const Connection&) = delete;
@@ -29,6 +51,9 @@ public:
 
     void handle();
 
+    // 若连接空闲超过 keepalive_timeout 且当前未被处理，则关闭连接并返回 true
+    bool closeIfIdle(std::chrono::steady_clock::time_point now);
+
     void setCloseRequestCallback(std::function<void(int)> callback);
 
 private:
@@ -37,15 +62,56 @@ private:
     EpollManager* epoll_manager_;
     Logger* logger_;
     StaticFile* static_file_;
+    AccessLog* access_log_;
+    Metrics* metrics_;
+    ConnectionOptions options_;
+    uint32_t peer_ip_;    // 客户端 IPv4 地址（网络字节序），用于访问日志
+    uint16_t peer_port_;  // 客户端端口
 
     std::atomic<bool> closed_{false};  // 是否关闭连接
+    std::mutex handle_mutex_;          // 保证同一连接同一时刻只被一个线程处理
+
+    HttpParser parser_;                            // 增量请求解析器
+    std::string input_buffer_;                     // 尚未处理完的输入数据
+    OutputBuffer output_buffer_;                   // 尚未发送完的响应数据
+    uint32_t registered_events_{EPOLLIN};          // 当前在 epoll 中注册的事件
+    bool close_after_write_{false};                // 输出队列发送完毕后关闭连接
+    size_t requests_served_{0};                    // 已处理的请求数
+    std::atomic<std::int64_t> last_active_ms_{0};  // 最近一次活动时间（steady_clock 毫秒）
 
     std::function<void(int)> callback_;
 
     void readAndHandleRequest();
 
-    [[nodiscard]] std::string handleGetRequest(const std::string& path) const;
-    [[nodiscard]] static std::string handlePostRequest(const std::string& path, const std::string& body);
+    // 读取 socket 中当前可读的全部数据到输入缓冲区，连接已关闭时返回 false
+    bool readFromClient();
+
+    // 处理一个完整的请求并将响应追加到输出队列，返回响应后是否保持连接
+    bool handleRequest(HttpRequest& request);
+
+    // 将请求记入访问日志与运行时指标：响应为输出队列中从第 first_segment 个片段开始、共 bytes 字节的内容
+    void recordRequest(std::string_view method, std::string_view target, size_t first_segment, size_t bytes,
+                      std::chrono::steady_clock::time_point received) const;
+
+    // 发送输出队列中的数据，连接因此被关闭时返回 false
+    bool flushOutput();
+
+    // 根据输出队列是否有积压，切换在 epoll 中关注的读写事件
+    void updateEvents();
+
+    // 处理 GET 与 HEAD 请求（HEAD 只返回头部）
+    void handleGetRequest(const HttpRequest& request);
+    [[nodiscard]] static std::string handlePostRequest(const std::string& path, const std::string& body,
+                                                       bool keep_alive);
+
+    // 根据 HTTP 版本、Connection 头部以及请求数上限判断本次响应后是否保持连接
+    [[nodiscard]] bool shouldKeepAlive(const HttpRequest& request) const;
+
+    // 更新最近活动时间
+    void touch();
+
+    // 请求关闭连接：先通知持有者移除自身，再关闭 socket
+    void requestClose();
 
     void closeConnection();
     void applyLinger(bool flag) const;
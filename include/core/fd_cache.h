@@ -0,0 +1,56 @@
+#ifndef CORE_FD_CACHE_H
+#define CORE_FD_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+#include <sys/stat.h>
+
+#include "utils/file_descriptor.h"
+
+// 缓存的已打开文件：描述符由输出队列中的 sendfile 片段共享，条目被移除后在最后一次发送完成时关闭
+struct CachedFile {
+    std::shared_ptr<const FileDescriptor> file;  // 已打开的文件
+    struct stat file_stat {};                    // 打开时的文件状态
+};
+
+// 热点大文件的描述符缓存（LRU），省去每次请求的路径解析与 open / fstat。
+// 条目不校验文件是否变化，只应在文件监视有效时使用，由监视回调移除失效的条目
+class FdCache {
+public:
+    // capacity 为最多保持打开的文件数（0 表示禁用）
+    explicit FdCache(size_t capacity);
+
+    [[nodiscard]] std::optional<CachedFile> find(const std::filesystem::path& path);
+
+    // 失效代数，打开文件前获取，插入时用于检测打开期间是否发生过失效
+    [[nodiscard]] uint64_t generation() const;
+
+    // 插入条目，必要时淘汰最久未使用的条目；打开期间发生过失效（代数不一致）时不插入
+    void insert(const std::filesystem::path& path, CachedFile file, uint64_t generation);
+
+    void erase(const std::filesystem::path& path);
+
+    // 移除 dir 目录树下的所有条目
+    void eraseUnder(const std::filesystem::path& dir);
+
+    [[nodiscard]] size_t size() const;
+
+private:
+    using Node = std::pair<std::filesystem::path, CachedFile>;
+
+    const size_t capacity_;                                                       // 容量
+    mutable std::mutex mutex_;                                                    // 保护以下成员
+    std::list<Node> lru_;                                                         // 按最近使用排序，表头最新
+    std::unordered_map<std::filesystem::path, std::list<Node>::iterator> index_;  // 路径到节点的索引
+    uint64_t generation_ = 0;                                                     // 失效代数
+};
+
+#endif  // CORE_FD_CACHE_H
@@ -0,0 +1,129 @@
+#ifndef CORE_FILE_CACHE_H
+#define CORE_FILE_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 前向声明
+class MappedFile;
+
+// 缓存条目：response 为序列化好的响应（200 的状态行与不含 Connection 的头部 + 正文 + 304 的状态行与头部），
+// 命中时只增加引用计数，不再拷贝
+struct CacheEntry {
+    std::shared_ptr<const std::string> response;    // 序列化的响应（mmap 模式下不含正文）
+    size_t header_size = 0;                         // response 中 200 头部的长度
+    size_t body_size = 0;                           // response 中正文的长度
+    std::string_view etag;                          // ETag 值，指向 response 中的头部
+    std::string_view content_type;                  // Content-Type 值，指向 response 中的头部（用于部分响应）
+    std::time_t modified_time = 0;                  // 最后修改时间（秒），用于 If-Modified-Since 比较
+    std::shared_ptr<const MappedFile> mapping;      // mmap 模式下的文件映射
+    std::filesystem::file_time_type last_modified;  // 最后修改时间
+    std::shared_ptr<const CacheEntry> gzip;         // gzip 压缩变体（不适合压缩时为空），ETag 与头部独立
+    std::shared_ptr<const CacheEntry> brotli;       // br 压缩变体（只来自预压缩文件，没有时为空）
+
+    // 设置序列化的响应（header_size 需已设置），并让 etag、content_type 指向其中对应的头部值
+    void setResponse(std::shared_ptr<const std::string> data) {
+        response = std::move(data);
+        etag = headerValue("ETag");
+        content_type = headerValue("Content-Type");
+    }
+
+    // 200 头部中指定字段的值（指向 response 的视图），不存在时为空
+    [[nodiscard]] std::string_view headerValue(std::string_view name) const;
+
+    // 304 响应的状态行与头部
+    [[nodiscard]] std::string_view notModifiedHeader() const {
+        return std::string_view(*response).substr(header_size + body_size);
+    }
+};
+
+// 缓存统计
+struct CacheStats {
+    uint64_t hits = 0;       // 命中次数
+    uint64_t misses = 0;     // 未命中次数（含过期）
+    uint64_t evictions = 0;  // 因容量不足被淘汰的条目数
+    size_t entries = 0;      // 当前条目数
+    size_t bytes = 0;        // 当前占用字节数
+};
+
+// 限定总字节数的静态文件缓存，容量不足时按 CLOCK（二次机会）算法淘汰最近未被访问的条目。
+// 缓存按路径哈希分为多个分片，每个分片使用读写锁：并发命中只持有共享锁，互不阻塞
+class FileCache {
+public:
+    // max_bytes 为缓存总字节数上限（0 表示禁用缓存），max_entry_bytes 为单个条目的字节数上限（0 表示不限制）；
+    // 分片数取 max_bytes / max_entry_bytes（最多 16），容量平均分配到各分片，不限制单条大小时不分片
+    FileCache(size_t max_bytes, size_t max_entry_bytes);
+
+    // 查找缓存，最后修改时间与 last_modified 不一致的条目视为过期并移除；
+    // last_modified 为空时直接信任缓存（文件变化由外部通过 erase / eraseUnder 推送）；
+    // 命中时返回条目的共享指针（只增加一次引用计数），未命中时返回空
+    [[nodiscard]] std::shared_ptr<const CacheEntry> find(
+        const std::filesystem::path& path, std::optional<std::filesystem::file_time_type> last_modified);
+
+    // 路径所在分片的失效代数，读取文件前获取，插入时用于检测读取期间是否发生过失效
+    [[nodiscard]] uint64_t generation(const std::filesystem::path& path);
+
+    // 插入或替换条目，必要时淘汰旧条目；条目超过单条上限，或读取期间该分片发生过失效（代数不一致）时不缓存并返回 false
+    bool insert(const std::filesystem::path& path, std::shared_ptr<const CacheEntry> entry, uint64_t generation);
+
+    void erase(const std::filesystem::path& path);
+
+    // 移除 dir 目录树下的所有条目
+    void eraseUnder(const std::filesystem::path& dir);
+
+    [[nodiscard]] CacheStats stats() const;
+
+private:
+    struct Node {
+        std::filesystem::path path;               // 缓存键
+        std::shared_ptr<const CacheEntry> entry;  // 缓存内容（插入后不再修改，命中时共享）
+        size_t charge = 0;                        // 计入容量的字节数
+        mutable std::atomic<bool> referenced{};   // CLOCK 访问位，命中时置位（共享锁下），指针扫过时清除
+    };
+
+    using NodeList = std::list<Node>;
+
+    // 分片：独立的 CLOCK 环、索引、容量与统计，按缓存行对齐避免分片之间的伪共享
+    // NOLINTNEXTLINE(readability-magic-numbers, cppcoreguidelines-avoid-magic-numbers)
+    struct alignas(64) Shard {
+        NodeList clock;                                                       // CLOCK 环
+        NodeList::iterator hand = clock.end();                                // CLOCK 指针
+        std::unordered_map<std::filesystem::path, NodeList::iterator> index;  // 路径到节点的索引
+        size_t bytes = 0;                                                     // 当前占用字节数
+        mutable std::shared_mutex mutex;
+
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> evictions{0};
+        std::atomic<uint64_t> generation{0};  // 失效代数，每次外部失效时递增
+
+        // 移除节点，返回下一个节点
+        NodeList::iterator removeNode(NodeList::iterator node);
+
+        // 淘汰条目直到能容纳 incoming 字节
+        void evictFor(size_t incoming, size_t max_bytes);
+    };
+
+    const size_t max_entry_bytes_;  // 单个条目的字节数上限
+    std::vector<Shard> shards_;     // 分片列表
+    const size_t shard_max_bytes_;  // 每个分片的字节数上限
+
+    [[nodiscard]] Shard& shardFor(const std::filesystem::path& path);
+
+    // 计算条目占用的字节数（序列化响应 + 压缩变体 + 文件映射 + 键）
+    [[nodiscard]] static size_t chargeOf(const std::filesystem::path& path, const CacheEntry& entry);
+};
+
+#endif  // CORE_FILE_CACHE_H
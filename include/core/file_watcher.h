@@ -0,0 +1,49 @@
+#ifndef CORE_FILE_WATCHER_H
+#define CORE_FILE_WATCHER_H
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <unordered_map>
+
+#include <sys/inotify.h>
+
+// 基于 inotify 的目录树监视器：为根目录及其所有子目录添加监视，文件或目录发生变化时通过回调通知。
+// 监视器只提供文件描述符，由调用方注册到 EpollManager 中，可读时调用 handleEvents
+class FileWatcher {
+public:
+    // path 为发生变化的路径，recursive 为 true 时表示该路径下的整棵目录树都需要失效
+    using Callback = std::function<void(const std::filesystem::path& path, bool recursive)>;
+
+    // 创建 inotify 实例并监视整棵目录树，失败时抛出异常
+    FileWatcher(const std::filesystem::path& root, Callback callback);
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+    FileWatcher(FileWatcher&&) = delete;
+    FileWatcher& operator=(FileWatcher&&) = delete;
+
+    [[nodiscard]] int getFd() const;
+
+    // 读取并处理所有待处理的事件（非线程安全，应只在一个线程中调用）
+    void handleEvents();
+
+    // 当前监视的目录数
+    [[nodiscard]] size_t watchCount() const;
+
+private:
+    int inotify_fd_;                                          // inotify 实例
+    std::filesystem::path root_;                              // 监视的根目录
+    std::unordered_map<int, std::filesystem::path> watches_;  // 监视描述符到目录路径的映射
+    Callback callback_;                                       // 变化通知回调
+
+    // 监视目录及其所有子目录
+    void addWatchRecursive(const std::filesystem::path& dir);
+
+    void addWatch(const std::filesystem::path& dir);
+
+    void handleEvent(const inotify_event& event);
+};
+
+#endif  // CORE_FILE_WATCHER_H
@@ -0,0 +1,78 @@
+#ifndef CORE_HTTP_PARSER_H
+#define CORE_HTTP_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "core/http_request.h"
+
+// 可恢复的 HTTP/1.x 请求解析器：数据可以分多次到达，每次调用 parse 都从上次停下的位置继续扫描，
+// 解析结果以视图形式指向调用方的输入缓冲区，不产生任何拷贝
+class HttpParser {
+public:
+    enum class State : std::uint8_t {
+        REQUEST_LINE,  // 等待请求行
+        HEADERS,       // 等待头部
+        BODY,          // 等待正文
+        COMPLETE,      // 已解析出一个完整请求
+        ERROR,         // 请求非法
+    };
+
+    HttpParser(size_t max_header_bytes, size_t max_body_bytes);
+
+    // 继续解析 data（从当前请求起始处开始的全部未消费数据），返回解析状态
+    State parse(std::string_view data);
+
+    // 解析完成的请求，仅在 parse 返回 COMPLETE 且输入缓冲区未被修改前有效
+    [[nodiscard]] HttpRequest& request();
+
+    // 完整请求（头部 + 正文）占用的字节数
+    [[nodiscard]] size_t requestSize() const;
+
+    // 解析失败时应返回给客户端的 HTTP 状态码
+    [[nodiscard]] int errorCode() const;
+
+    // 重置状态，准备解析下一个请求
+    void reset();
+
+private:
+    struct Range {
+        size_t offset = 0;
+        size_t length = 0;
+    };
+
+    struct HeaderRange {
+        Range name;
+        Range value;
+    };
+
+    const size_t max_header_bytes_;  // 请求行 + 头部允许的最大字节数
+    const size_t max_body_bytes_;    // 正文允许的最大字节数
+
+    State state_ = State::REQUEST_LINE;
+    size_t scan_pos_ = 0;        // 下一次查找 CRLF 的起始位置
+    size_t line_start_ = 0;      // 当前行的起始位置
+    size_t body_start_ = 0;      // 正文起始位置
+    size_t content_length_ = 0;  // 正文长度
+    int error_code_ = 0;
+
+    Range method_;
+    Range target_;
+    Range version_;
+    std::vector<HeaderRange> header_ranges_;  // 解析过程中只记录偏移，缓冲区扩容后依然有效
+
+    HttpRequest request_;
+
+    State parseRequestLine(std::string_view data);
+    State parseHeaders(std::string_view data);
+    State parseBody(std::string_view data);
+
+    // 头部解析完毕后根据 Content-Length / Transfer-Encoding 确定正文长度
+    State finishHeaders(std::string_view data);
+
+    State fail(int code);
+};
+
+#endif  // CORE_HTTP_PARSER_H
@@ -0,0 +1,41 @@
+#ifndef CORE_HTTP_REQUEST_H
+#define CORE_HTTP_REQUEST_H
+
+#include <optional>
+#include <string_view>
+#include <vector>
+
+struct HttpHeader {
+    std::string_view name;
+    std::string_view value;
+};
+
+// 解析完成的 HTTP 请求：所有字段都是指向连接输入缓冲区的视图，仅在该请求被处理期间有效
+struct HttpRequest {
+    std::string_view method;          // 请求方法（如 GET）
+    std::string_view target;          // 请求目标（含查询字符串）
+    std::string_view version;         // 协议版本（如 HTTP/1.1）
+    std::vector<HttpHeader> headers;  // 头部字段（保持原始顺序）
+    std::string_view body;            // 请求正文
+    bool keep_alive = false;          // 响应后是否保持连接（由 Connection 决定）
+
+    // 按名称查找头部字段（不区分大小写）
+    [[nodiscard]] std::optional<std::string_view> header(std::string_view name) const;
+
+    // 去掉查询字符串后的路径
+    [[nodiscard]] std::string_view path() const;
+
+    // 查询字符串（不含 '?'）
+    [[nodiscard]] std::string_view query() const;
+
+    // 根据 HTTP 版本与 Connection 头部判断客户端是否希望保持连接
+    [[nodiscard]] bool keepAliveRequested() const;
+
+    // 不区分大小写比较
+    [[nodiscard]] static bool equalsIgnoreCase(std::string_view lhs, std::string_view rhs);
+
+    // 判断以逗号分隔的头部值中是否包含指定的 token（如 "keep-alive, Upgrade"）
+    [[nodiscard]] static bool containsToken(std::string_view value, std::string_view token);
+};
+
+#endif  // CORE_HTTP_REQUEST_H
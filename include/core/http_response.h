@@ -1,8 +1,11 @@
 #ifndef CORE_HTTP_RESPONSE_H
 #define CORE_HTTP_RESPONSE_H
 
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include <string>
+#include <string_view>
 
 class HttpResponse {
 public:
@@ -14,13 +17,33 @@ public:
 
     HttpResponse& addHeader(const std::string& key, const std::string& value);
 
+    HttpResponse& setKeepAlive(bool keep_alive);
+
+    // HEAD 请求的响应：保留 Content-Length 等头部，但不发送正文
+    HttpResponse& setHeadOnly(bool head_only);
+
     [[nodiscard]] std::string build();
 
-    [[nodiscard]] static std::string buildErrorResponse(int code, const std::string& tips = "");
+    // 只生成状态行与头部（含结尾空行），正文由调用方另行发送
+    [[nodiscard]] std::string buildHeader(size_t content_length);
+
+    // 生成状态行与除 Connection 以外的头部（不含结尾空行），供缓存复用，发送时再接上 connectionLine
+    [[nodiscard]] std::string buildHeaderFields(size_t content_length);
+
+    // Connection 头部与头部结尾的空行（静态存储）
+    [[nodiscard]] static std::string_view connectionLine(bool keep_alive);
+
+    [[nodiscard]] static std::string buildErrorResponse(int code, const std::string& tips = "",
+                                                        bool keep_alive = false, bool head_only = false);
+
+    // 从响应开头的状态行（HTTP/1.1 200 OK）中取出状态码，格式不符时返回 0
+    [[nodiscard]] static uint16_t statusOf(std::string_view response);
 
 private:
     std::string status_ = "200 OK";
     std::string body_;
+    bool keep_alive_ = false;
+    bool head_only_ = false;
     std::map<std::string, std::string> headers_;
 };
 
@@ -0,0 +1,83 @@
+#ifndef CORE_METRICS_H
+#define CORE_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utils/latency_histogram.h"
+
+// 运行时指标：请求数（按状态码）、响应字节数、连接数与请求耗时直方图写入各线程独占的分片，
+// 记录时只修改本线程的缓存行，抓取时合并所有分片并以 Prometheus 文本格式输出；
+// 其他模块的统计（静态文件缓存、线程池、访问日志）由登记的采集函数在抓取时追加
+class Metrics {
+public:
+    // 采集函数：抓取时调用，向输出追加指标
+    using Collector = std::function<void(std::string&)>;
+
+    // Prometheus 文本格式的 Content-Type
+    static constexpr std::string_view CONTENT_TYPE = "text/plain; version=0.0.4; charset=utf-8";
+
+    // path 为提供指标的请求路径（如 /metrics）
+    explicit Metrics(std::string path);
+
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+    Metrics(Metrics&&) = delete;
+    Metrics& operator=(Metrics&&) = delete;
+
+    [[nodiscard]] const std::string& path() const { return path_; }
+
+    // 记录一个已处理的请求
+    void recordRequest(uint16_t status, uint64_t bytes, std::chrono::microseconds latency);
+
+    // 记录连接的建立与关闭
+    void connectionOpened();
+    void connectionClosed();
+
+    // 登记采集函数（需在开始处理请求前调用，采集函数引用的对象须在最后一次抓取后才销毁）
+    void addCollector(Collector collector);
+
+    // 合并各线程的分片，生成 Prometheus 文本格式的全部指标
+    [[nodiscard]] std::string render() const;
+
+    // 向 out 追加一个无标签的计数器 / 仪表（含 HELP 与 TYPE 行），供采集函数使用
+    static void writeCounter(std::string& out, std::string_view name, std::string_view help, uint64_t value);
+    static void writeCounter(std::string& out, std::string_view name, std::string_view help, double value);
+    static void writeGauge(std::string& out, std::string_view name, std::string_view help, double value);
+
+private:
+    static constexpr size_t STATUS_CODE_LIMIT = 600;  // 状态码计数表的大小，超出范围的状态码计入 0
+
+    // 一个线程的计数，按缓存行对齐避免线程之间的伪共享；只由持有它的线程写入，线程退出后由新线程接管继续累加
+    // NOLINTNEXTLINE(readability-magic-numbers, cppcoreguidelines-avoid-magic-numbers)
+    struct alignas(64) Shard {
+        std::array<std::atomic<uint64_t>, STATUS_CODE_LIMIT> requests{};  // 按状态码的请求数
+        std::atomic<uint64_t> response_bytes{0};                          // 响应字节数
+        std::atomic<uint64_t> connections_opened{0};                      // 建立的连接数
+        std::atomic<uint64_t> connections_closed{0};                      // 关闭的连接数
+        LatencyHistogram latency;                                         // 请求耗时（微秒）
+        std::atomic<bool> in_use{false};                                  // 是否有线程持有
+    };
+
+    const std::string path_;
+    const uint64_t instance_id_;  // 实例编号，线程缓存的分片据此判断归属
+    const std::chrono::system_clock::time_point start_time_;
+
+    mutable std::mutex mutex_;                    // 保护 shards_ 与 collectors_
+    std::vector<std::shared_ptr<Shard>> shards_;  // 所有分片（只增不减）
+    std::vector<Collector> collectors_;
+
+    // 获取当前线程的分片，首次调用时接管一个空闲分片或新建一个
+    Shard& threadShard();
+};
+
+#endif  // CORE_METRICS_H
@@ -0,0 +1,52 @@
+#ifndef CORE_METRICS_SERVER_H
+#define CORE_METRICS_SERVER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+// 前向声明
+class Logger;
+class Metrics;
+
+// 指标端口参数
+struct MetricsServerOptions {
+    std::string address = "127.0.0.1";  // 监听的 IPv4 地址
+    uint16_t port = 0;                  // 监听端口（0 表示不单独监听，指标在对外端口的 metrics_path 提供）
+};
+
+// 独立的指标端口：在单独的线程中逐个处理连接，只在 Metrics 的路径上提供指标（其他路径返回 404），
+// 不经过 Server 的 epoll、线程池与静态文件处理，指标不会出现在对外的端口上。抓取频率很低，串行处理即可，
+// 读取整个请求共用一个截止时间、发送有超时，慢客户端不会长期占用线程
+class MetricsServer {
+public:
+    // 绑定地址并开始监听，随后启动处理线程；地址无效或监听失败时抛出异常。
+    // 需在 Server 构造完成（采集函数已登记）之后创建、在其销毁之前销毁
+    MetricsServer(const MetricsServerOptions& options, Metrics* metrics, Logger* logger);
+
+    // 关闭监听 socket 并等待处理线程退出
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+    MetricsServer(MetricsServer&&) = delete;
+    MetricsServer& operator=(MetricsServer&&) = delete;
+
+private:
+    const MetricsServerOptions options_;
+    Metrics* metrics_;
+    Logger* logger_;
+    int listen_fd_{-1};
+
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+
+    // 处理线程主函数：等待并接受连接，逐个处理
+    void loop();
+
+    // 读取一个请求并返回指标、404 或错误响应，随后关闭连接
+    void handleClient(int client_fd) const;
+};
+
+#endif  // CORE_METRICS_SERVER_H
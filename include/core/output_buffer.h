@@ -0,0 +1,76 @@
+#ifndef CORE_OUTPUT_BUFFER_H
+#define CORE_OUTPUT_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <sys/types.h>
+
+// 连接的输出队列：按顺序保存待发送的响应片段，内存片段使用 writev 批量发送，文件片段使用 sendfile 零拷贝发送，
+// 内核发送缓冲区写满时保留剩余数据，等待 EPOLLOUT 后继续发送
+class OutputBuffer {
+public:
+    enum class FlushResult : std::uint8_t {
+        DONE,   // 全部发送完毕
+        AGAIN,  // 内核缓冲区已满，需要等待可写事件
+        ERROR,  // 发送失败，连接应关闭
+    };
+
+    // 追加一段自有数据
+    void append(std::string data);
+
+    // 追加一段只读的共享数据，owner 保证数据在发送完成前有效（静态存储可传空）
+    void append(std::string_view data, std::shared_ptr<const void> owner);
+
+    // 追加一段文件内容，由 sendfile 直接从页缓存发送，owner 保证文件描述符在发送完成前有效
+    void appendFile(int file_fd, off_t offset, size_t length, std::shared_ptr<const void> owner);
+
+    [[nodiscard]] bool empty() const;
+
+    // 尚未发送的字节数
+    [[nodiscard]] size_t size() const;
+
+    // 队列中的片段数：在追加一个响应前记录，之后可通过 segmentData 读取该响应的第一个片段（期间不能发送）
+    [[nodiscard]] size_t segmentCount() const;
+
+    // 第 index 个片段的内容（文件片段返回空）
+    [[nodiscard]] std::string_view segmentData(size_t index) const;
+
+    // 尽可能多地发送数据
+    FlushResult flush(int socket_fd);
+
+    void clear();
+
+private:
+    struct Segment {
+        std::string owned{};                  // 自有数据
+        std::string_view view{};              // 共享数据视图（owned 为空时使用）
+        std::shared_ptr<const void> owner{};  // 共享数据或文件描述符的所有者
+        int file_fd = -1;                     // 文件片段的描述符（-1 表示内存片段）
+        off_t file_offset = 0;                // 文件片段的起始偏移
+        size_t file_length = 0;               // 文件片段的长度
+
+        [[nodiscard]] bool isFile() const { return file_fd != -1; }
+        [[nodiscard]] std::string_view data() const { return owned.empty() ? view : std::string_view(owned); }
+        [[nodiscard]] size_t size() const { return isFile() ? file_length : data().size(); }
+    };
+
+    std::deque<Segment> segments_;
+    size_t front_offset_ = 0;   // 队首片段已发送的字节数
+    size_t pending_bytes_ = 0;  // 尚未发送的总字节数
+
+    // 使用 writev 发送队首连续的内存片段，返回发送的字节数（-1 表示出错）
+    ssize_t sendMemory(int socket_fd);
+
+    // 使用 sendfile 发送队首的文件片段，返回发送的字节数（-1 表示出错）
+    ssize_t sendFile(int socket_fd);
+
+    // 丢弃已发送的 bytes 字节
+    void consume(size_t bytes);
+};
+
+#endif  // CORE_OUTPUT_BUFFER_H
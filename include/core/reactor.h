@@ -0,0 +1,81 @@
+#ifndef CORE_REACTOR_H
+#define CORE_REACTOR_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+
+#include "core/connection.h"
+#include "core/epoll_manager.h"
+
+// 前向声明
+class AccessLog;
+class Logger;
+class Metrics;
+class StaticFile;
+
+// 单个事件循环：独占一个线程、一个 epoll 实例、一个 SO_REUSEPORT 监听 socket 以及自己的连接表，
+// 由它接受的连接在整个生命周期内都只由该线程处理，因此无需任何跨线程同步
+class Reactor {
+public:
+    Reactor(size_t reactor_id, uint16_t port, const ConnectionOptions& options, Logger* logger,
+            StaticFile* static_file, AccessLog* access_log, Metrics* metrics);
+    ~Reactor();
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+    Reactor(Reactor&&) = delete;
+    Reactor& operator=(Reactor&&) = delete;
+
+    // 启动事件循环线程
+    void start();
+
+    // 等待事件循环线程结束
+    void join();
+
+    // 通知事件循环退出并等待线程结束
+    void stop();
+
+private:
+    const size_t id_;                  // 事件循环编号
+    const uint16_t port_;              // 监听端口
+    const ConnectionOptions options_;  // 连接参数
+    int listen_fd_{-1};                // 本事件循环独占的监听 socket
+
+    std::unordered_map<int, std::shared_ptr<Connection>> connections_;  // 本事件循环的连接表（仅本线程访问）
+    std::chrono::steady_clock::time_point last_idle_check_;             // 上次检查空闲连接的时间
+    bool accept_paused_{false};                                         // 是否因 accept 失败暂停监听
+    std::chrono::steady_clock::time_point accept_resume_time_;          // 恢复监听的时间
+
+    Logger* logger_;              // 日志
+    StaticFile* static_file_;     // 静态文件服务（线程安全，多个事件循环共享）
+    AccessLog* access_log_;       // 访问日志（线程安全，多个事件循环共享，可为空）
+    Metrics* metrics_;            // 运行时指标（线程安全，多个事件循环共享，可为空）
+    EpollManager epoll_manager_;  // 本事件循环独占的 epoll 实例
+
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+
+    // 事件循环主函数
+    void loop();
+
+    // 接受所有就绪的新连接
+    void handleNewConnection();
+
+    // accept 失败（如描述符耗尽）时暂停监听，避免边缘触发下丢失积压连接的通知
+    void pauseAccept();
+
+    // 暂停时间已到时重新注册监听 socket
+    void resumeAcceptIfDue();
+
+    // 在本线程内直接处理客户端事件
+    void handleClient(int client_fd);
+
+    // 关闭空闲超时的长连接
+    void closeIdleConnections();
+};
+
+#endif  // CORE_REACTOR_H
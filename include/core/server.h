@@ -1,23 +1,33 @@
 #ifndef CORE_SERVER_H
 #define CORE_SERVER_H
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
+#include "core/connection.h"
 #include "core/epoll_manager.h"
+#include "core/reactor.h"
 #include "core/static_file.h"
 #include "core/threadpool.h"
 
 // 前向声明
-class Connection;
+class AccessLog;
 class Logger;
+class Metrics;
 
 class Server {
 public:
     // 构造函数：初始化服务器并指定监听端口
-    explicit Server(uint16_t port, bool linger, Logger* logger, size_t thread_count);
+    // reactor_count 为 0 时使用单 epoll + 线程池模式，否则启动对应数量的独立事件循环（多 Reactor 模式，不使用线程池）；
+    // 线程池模式下待处理任务超过 pool_options.queue_capacity 时，新到达的请求所在连接被直接关闭；
+    // access_log 为空时不记录访问日志；metrics 为空时不统计运行时指标，否则登记静态文件缓存、线程池与访问日志的采集函数
+    explicit Server(uint16_t port, const ConnectionOptions& options, const StaticFileOptions& static_options,
+                    const ThreadPoolOptions& pool_options, Logger* logger, AccessLog* access_log, Metrics* metrics,
+                    size_t reactor_count = 0);
 
     // 析构函数：关闭 socket 与 epoll 相关资源
     ~Server();
@@ -31,17 +41,22 @@ public:
     void run();
 
 private:
-    const uint16_t port_;  // 服务器监听端口
-    int listen_fd_{};      // 监听 socket 文件描述符
-    const bool linger_;    // 是否启用 linger 模式
+    const uint16_t port_;        // 服务器监听端口
+    int listen_fd_{-1};          // 监听 socket 文件描述符
+    ConnectionOptions options_;  // 连接参数（linger、长连接等）
+
+    std::vector<std::unique_ptr<Reactor>> reactors_;  // 多 Reactor 模式下的事件循环列表
 
     std::unordered_map<int, std::shared_ptr<Connection>> connections_;  // 客户端连接列表
     std::mutex connections_mutex_;
+    std::chrono::steady_clock::time_point last_idle_check_;  // 上次检查空闲连接的时间
 
-    Logger* logger_;                               // 日志
-    EpollManager epoll_manager_;                   // epoll 管理器
-    ThreadPool thread_pool_;                       // 线程池
-    StaticFile static_file_{logger_, "./static"};  // 静态文件目录
+    Logger* logger_;              // 日志
+    AccessLog* access_log_;       // 访问日志（可为空）
+    Metrics* metrics_;            // 运行时指标（可为空）
+    EpollManager epoll_manager_;  // epoll 管理器
+    ThreadPool thread_pool_;      // 线程池
+    StaticFile static_file_;      // 静态文件目录
 
     // 创建并配置 socket，绑定端口并监听连接
     void setupSocket();
@@ -55,8 +70,20 @@ private:
     // 分发任务
     void dispatchClient(int client_fd);
 
-    // 设置为非阻塞模式
-    static int setNonBlocking(int socket_fd);
+    // 任务无法提交时关闭连接（过载降载）
+    void shedClient(int client_fd);
+
+    // 关闭空闲超时的长连接
+    void closeIdleConnections();
+
+    // 将静态文件监视器注册到 epoll
+    void setupWatcher() const;
+
+    // 创建多 Reactor 模式下的事件循环
+    void setupReactors(size_t reactor_count);
+
+    // 向运行时指标登记静态文件缓存、线程池（线程池模式）与访问日志的采集函数
+    void registerMetrics();
 };
 
 #endif  // CORE_SERVER_H
@@ -0,0 +1,46 @@
+#ifndef CORE_STATIC_ARCHIVE_H
+#define CORE_STATIC_ARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string_view>
+
+#include "utils/archive_format.h"
+
+// 前向声明
+class MappedFile;
+
+// 只读的静态资源归档（格式见 utils/archive_format.h）：整个文件以 mmap 映射，加载时只校验文件头与表的边界，
+// 不读取、不解析任何资源，启动耗时与资源数量无关；查找为一次完美哈希探测，响应头与正文都是映射中的视图
+class StaticArchive {
+public:
+    // 打开并映射归档文件，文件不存在、格式或版本不符、表越界时抛出异常
+    explicit StaticArchive(const std::filesystem::path& path);
+
+    // 按相对于静态根目录的路径（如 images/a.png）查找资源，不存在或条目中的区间越界时返回 nullptr
+    [[nodiscard]] const ArchiveEntry* find(std::string_view path) const;
+
+    // 区间对应的数据（只应传入 find 返回的条目中的区间，这些区间已经校验过）
+    [[nodiscard]] std::string_view view(const ArchiveSpan& span) const;
+
+    // 整个映射，作为输出队列中视图的所有者
+    [[nodiscard]] const std::shared_ptr<const MappedFile>& mapping() const;
+
+    [[nodiscard]] size_t entryCount() const;
+
+private:
+    std::shared_ptr<const MappedFile> mapping_;  // 归档文件的映射
+    std::span<const int32_t> displacements_;     // 完美哈希的位移表
+    std::span<const ArchiveEntry> entries_;      // 条目表（按槽位排列）
+
+    // 区间是否位于文件之内
+    [[nodiscard]] bool contains(const ArchiveSpan& span) const;
+
+    // 条目的所有区间是否都位于文件之内
+    [[nodiscard]] bool isValid(const ArchiveEntry& entry) const;
+};
+
+#endif  // CORE_STATIC_ARCHIVE_H
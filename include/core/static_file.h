@@ -1,47 +1,218 @@
 #ifndef CORE_STATIC_FILE_H
 #define CORE_STATIC_FILE_H
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
 #include <filesystem>
-#include <mutex>
+#include <memory>
 #include <optional>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 
+#include <sys/stat.h>
+
+#include "core/fd_cache.h"
+#include "core/file_cache.h"
+#include "core/file_watcher.h"
 #include "core/http_response.h"
+#include "core/static_archive.h"
+#include "utils/file_descriptor.h"
 
-struct CacheEntry {
-    HttpResponse builder{};                         // 文件内容
-    std::filesystem::file_time_type last_modified;  // 最后修改时间
+// 静态文件服务参数
+struct StaticFileOptions {
+    size_t sendfile_threshold = 65536;       // 不小于该大小的文件使用 sendfile 直接发送且不进入缓存（0 表示禁用）
+    bool mmap_cache = false;                 // 缓存以只读 mmap 引用文件内容，而不是拷贝到堆内存
+    size_t cache_max_bytes = 67108864;       // 缓存总字节数上限（0 表示禁用缓存）
+    size_t cache_max_entry_bytes = 1048576;  // 单个缓存条目的字节数上限（0 表示不限制）
+    bool watch_files = true;                 // 使用 inotify 监视静态目录，缓存命中时不再检查文件修改时间
+    bool compression = true;                 // 对文本类资源协商 gzip 压缩，压缩结果与原始内容一起缓存
+    size_t fd_cache_size = 64;               // 保持打开的大文件描述符数（只在文件监视有效时使用，0 表示禁用）
+    std::string archive_path;                // 静态资源归档（由 PackStatic 生成），为空时不使用；相对路径基于项目根目录
 };
 
 // 前向声明
 class Address;
 class Logger;
+class OutputBuffer;
+struct HttpRequest;
 
 class StaticFile {
 public:
-    explicit StaticFile(Logger* logger, std::string_view relative_path = "./static");
+    explicit StaticFile(Logger* logger, const StaticFileOptions& options = {},
+                        std::string_view relative_path = "./static");
+
+    // 处理静态文件请求，将响应追加到连接的输出队列
+    void serve(const HttpRequest& request, const Address& info, OutputBuffer& output) const;
+
+    // 缓存命中、未命中与淘汰统计
+    [[nodiscard]] CacheStats cacheStats() const;
+
+    // 文件监视器的描述符，未启用时返回 -1，由服务器注册到 epoll 中
+    [[nodiscard]] int watchFd() const;
 
-    [[nodiscard]] std::string serve(const std::string& path, const Address& info) const;
+    // 处理文件监视事件，使发生变化的文件对应的缓存失效（只应在一个线程中调用）
+    void handleWatchEvents();
 
 private:
+    // 部分响应的正文来源：内存中的完整正文（缓存条目）或文件描述符（sendfile）
+    struct RangeSource {
+        std::string_view content_type;      // 资源的 Content-Type
+        std::string_view etag;              // 资源的 ETag
+        std::time_t modified_time = 0;      // 资源的最后修改时间（秒）
+        size_t size = 0;                    // 资源大小
+        std::string_view data;              // 内存中的正文（file_fd 为 -1 时使用）
+        int file_fd = -1;                   // 正文所在的文件描述符
+        std::shared_ptr<const void> owner;  // 保证 data 或 file_fd 在发送完成前有效
+    };
+
+    // 一种表示的完整响应（来自缓存条目或静态归档），各部分均为视图，由 owner 保证发送期间有效
+    struct Representation {
+        std::string_view header;                   // 200 状态行与头部（不含 Connection 与结尾空行）
+        std::string_view not_modified;             // 304 状态行与头部
+        std::string_view body;                     // 正文
+        std::string_view etag;                     // ETag 值
+        std::string_view content_type;             // Content-Type 值
+        std::time_t modified_time = 0;             // 最后修改时间（秒）
+        std::shared_ptr<const void> header_owner;  // header 与 not_modified 的所有者
+        std::shared_ptr<const void> body_owner;    // body 的所有者
+    };
+
+    enum class OpenStatus : uint8_t {
+        OPENED,     // 已打开（文件或目录）
+        FORBIDDEN,  // 解析结果越出根目录
+        NOT_FOUND,  // 不存在或无法打开
+    };
+
+    // 在根目录之下打开请求路径的结果
+    struct OpenedFile {
+        OpenStatus status = OpenStatus::NOT_FOUND;
+        FileDescriptor file;           // 已打开的文件或目录
+        struct stat file_stat {};      // 文件状态
+        bool through_symlink = false;  // 解析经过了符号链接（可能位于监视范围之外，监视有效时不缓存）
+    };
+
+    // 预压缩文件（如 index.html.gz）
+    struct Sidecar {
+        FileDescriptor file;        // 已打开的预压缩文件
+        struct stat file_stat {};   // 预压缩文件的状态
+        std::string_view encoding;  // 对应的 Content-Encoding（静态存储）
+    };
+
     std::filesystem::path root_;  // 静态文件根目录
+    FileDescriptor root_fd_;      // 根目录的 O_PATH 描述符，作为 openat2 解析的起点
+    bool openat2_ = false;        // 内核是否支持 openat2
+    StaticFileOptions options_;   // 静态文件服务参数
     Logger* logger_;              // 日志
 
-    mutable std::unordered_map<std::filesystem::path, CacheEntry> cache_;
-    mutable std::mutex cache_mutex_;
+    mutable FileCache cache_;                 // 文件缓存
+    mutable FdCache fd_cache_;                // 热点大文件的描述符缓存
+    std::unique_ptr<FileWatcher> watcher_;    // 文件监视器
+    std::atomic<bool> watching_{false};       // 监视是否有效，有效时缓存命中无需校验修改时间
+    std::unique_ptr<StaticArchive> archive_;  // 静态资源归档，未配置或加载失败时为空
+
+    // 路径是否位于根目录之下（只做词法比较，不访问文件系统）
+    [[nodiscard]] bool isUnderRoot(const std::filesystem::path& path) const;
 
-    [[nodiscard]] bool isPathSafe(const std::filesystem::path& path) const;
+    // 相对于根目录的路径（不含开头的斜杠，根目录自身为空），指向 full_path 内部
+    [[nodiscard]] std::string_view relativePath(const std::filesystem::path& full_path) const;
+
+    // 在根目录之下打开路径：支持 openat2 时由内核以 RESOLVE_BENEATH 在一次系统调用中保证不越出根目录，
+    // 否则解析符号链接后检查路径再打开
+    [[nodiscard]] OpenedFile openBeneath(const std::filesystem::path& full_path,
+                                         std::string_view relative_path) const;
 
     [[nodiscard]] std::filesystem::path getFilePath(const std::string& path) const;
 
-    [[nodiscard]] std::optional<HttpResponse> readFromCache(const std::filesystem::path& path,
-                                                            const Address& info) const;
+    // 查找缓存条目，未命中时返回空；未启用文件监视时先确认文件未被修改
+    [[nodiscard]] std::shared_ptr<const CacheEntry> readFromCache(const std::filesystem::path& path,
+                                                                  const Address& info) const;
+
+    // 处理目录请求：缺少结尾斜杠时重定向，否则发送（并缓存）目录列表
+    void serveDirectory(const HttpRequest& request, const Address& info, const std::filesystem::path& full_path,
+                        int dir_fd, uint64_t generation, bool through_symlink, OutputBuffer& output) const;
+
+    // 生成目录的 HTML 列表（链接均为相对路径，与请求路径的写法无关），modified_time 返回目录及其中各项的最新修改时间；
+    // 遍历已打开的目录描述符 dir_fd，dir_path 只用于生成标题
+    [[nodiscard]] std::string generateDirectoryListing(const std::filesystem::path& dir_path, int dir_fd,
+                                                       std::time_t& modified_time) const;
+
+    // 生成目录列表的缓存条目（200 / 304 头部已序列化，启用压缩时附带 gzip 变体）
+    [[nodiscard]] std::shared_ptr<CacheEntry> makeListingEntry(const std::filesystem::path& dir_path,
+                                                               int dir_fd) const;
+
+    // 存入缓存，条目超过单条上限、文件已丢失、读取期间发生过失效，或监视有效时经由符号链接访问时返回 false
+    // 插入前设置条目的 last_modified，之后条目不再修改
+    bool updateCache(const std::filesystem::path& path, const std::shared_ptr<CacheEntry>& entry, uint64_t generation,
+                     bool through_symlink) const;
+
+    // 文件监视回调：使 path（recursive 时为整棵目录树）对应的缓存失效
+    void invalidate(const std::filesystem::path& path, bool recursive) const;
+
+    // 将缓存条目作为响应追加到输出队列，客户端接受压缩编码时使用压缩变体
+    static void appendCacheEntry(const std::shared_ptr<const CacheEntry>& cached, const HttpRequest& request,
+                                 OutputBuffer& output);
+
+    // 将归档中的资源作为响应追加到输出队列，客户端接受压缩编码时使用压缩表示
+    void appendArchiveEntry(const ArchiveEntry& entry, const HttpRequest& request, OutputBuffer& output) const;
+
+    // 追加一种表示的响应：条件请求命中时只追加 304 头部，范围请求追加 206 / 416，HEAD 请求不追加正文
+    static void appendRepresentation(const Representation& representation, const HttpRequest& request,
+                                     OutputBuffer& output);
+
+    // 根据 If-None-Match / If-Modified-Since 判断客户端缓存是否仍然有效
+    [[nodiscard]] static bool isNotModified(const HttpRequest& request, std::string_view etag,
+                                            std::time_t modified_time);
+
+    // GET 请求的 Range 头部，其他方法不处理范围请求（RFC 9110 14.2）
+    [[nodiscard]] static std::optional<std::string_view> rangeHeader(const HttpRequest& request);
+
+    // 处理范围请求：追加 206（单个范围或 multipart/byteranges）或 416 响应并返回 true；
+    // If-Range 不成立或 Range 无效时返回 false，由调用方发送完整响应
+    static bool appendRanges(const HttpRequest& request, std::string_view range, const RangeSource& source,
+                             OutputBuffer& output);
+
+    // If-Range 是否成立（强比较 ETag 或精确匹配最后修改时间），不存在时视为成立
+    [[nodiscard]] static bool matchesIfRange(const HttpRequest& request, std::string_view etag,
+                                             std::time_t modified_time);
+
+    // 以 sendfile 发送文件（含 304 与范围请求），builder 中已设置除 ETag 以外的公共头部，
+    // modified_time 为原文件的修改时间（发送预压缩文件时用于条件请求）
+    void sendFile(const HttpRequest& request, const Address& info, std::shared_ptr<const FileDescriptor> file,
+                  const struct stat& file_stat, std::time_t modified_time, std::string_view content_type,
+                  HttpResponse builder, OutputBuffer& output) const;
+
+    // 为缓存条目生成压缩变体：优先读取未过期的预压缩文件，没有 gzip 预压缩文件时压缩一次（无收益时不生成）；
+    // mmap 模式下压缩的输入从 file_fd 读取副本，不直接读取映射
+    void addVariants(CacheEntry& entry, int file_fd, const std::filesystem::path& path, const struct stat& file_stat,
+                     const HttpResponse& builder, std::string_view etag) const;
+
+    // 由编码后的正文生成缓存变体，头部带有 Content-Encoding 与该表示独立的 ETag
+    [[nodiscard]] static std::shared_ptr<const CacheEntry> makeVariant(std::string_view body,
+                                                                       std::string_view encoding,
+                                                                       const std::string& etag, HttpResponse builder,
+                                                                       std::time_t modified_time);
+
+    // 按 Accept-Encoding 在可用的压缩编码中选择（q 值相同时优先 br），都不接受时返回空（使用原始表示）
+    [[nodiscard]] static std::string_view negotiateEncoding(const HttpRequest& request, bool brotli_available,
+                                                            bool gzip_available);
+
+    // 按 Accept-Encoding 选择缓存条目的表示，都不接受时返回原始表示
+    [[nodiscard]] static const CacheEntry& selectVariant(const CacheEntry& cached, const HttpRequest& request);
+
+    // 按客户端偏好打开未过期的预压缩文件，都不可用时返回空
+    [[nodiscard]] std::optional<Sidecar> openPreferredSidecar(const std::filesystem::path& path,
+                                                              const struct stat& original,
+                                                              const HttpRequest& request) const;
 
-    [[nodiscard]] static std::string generateDirectoryListing(const std::filesystem::path& dir_path,
-                                                              const std::string& request_path);
+    // 打开原文件 path 加上 suffix 的预压缩文件，与原文件一样经 openat2 在根目录之下解析；
+    // 不存在、不是普通文件、路径中含有符号链接或比原文件旧时返回空
+    [[nodiscard]] std::optional<Sidecar> openSidecar(const std::filesystem::path& path, std::string_view suffix,
+                                                     const struct stat& original) const;
 
-    void updateCache(const std::filesystem::path& path, const HttpResponse& builder) const;
+    // 预压缩文件路径（原路径 + 后缀，如 index.html.gz）
+    [[nodiscard]] static std::filesystem::path sidecarPath(const std::filesystem::path& path, std::string_view suffix);
 };
 
 #endif  // CORE_STATIC_FILE_H
@@ -1,21 +1,50 @@
 #ifndef CORE_THREADPOOL_H
 #define CORE_THREADPOOL_H
 
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
-#include <functional>
-#include <queue>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 
+#include "utils/event_count.h"
+#include "utils/inline_task.h"
+#include "utils/mpmc_queue.h"
+#include "utils/work_stealing_deque.h"
+
 class Logger;
 
-// 简单的线程池实现：用于将任务分发给固定数量的线程执行
+// 线程池的可配置参数
+struct ThreadPoolOptions {
+    size_t threads = 0;            // 初始线程数（0 表示不启动工作线程）
+    size_t min_threads = 0;        // 自适应调整的下限
+    size_t max_threads = 0;        // 自适应调整的上限（不大于 min_threads 时线程数固定）
+    size_t queue_capacity = 1024;  // 外部提交任务的总容量（平均分配到各线程的收件箱）
+};
+
+// 线程池的运行统计（各计数为启动以来的累计值）
+struct ThreadPoolStats {
+    size_t threads = 0;    // 活跃线程数
+    size_t queued = 0;     // 排队中的任务数
+    uint64_t tasks = 0;    // 已执行的任务数
+    uint64_t wait_ns = 0;  // 任务累计排队等待时间
+    uint64_t busy_ns = 0;  // 任务累计执行时间
+};
+
+// 工作窃取线程池：外部提交的任务按轮转放入各工作线程的有界无锁收件箱（MPMC 环形队列），
+// 工作线程提交的任务压入自己的 Chase-Lev 双端队列；空闲线程从其他线程的队列与收件箱窃取任务，没有任务时通过事件计数器休眠。
+// 任务为内联存储的 InlineTask，外部提交不分配内存，收件箱写满时提交失败，由调用方降载。
+// 线程数在 [min_threads, max_threads] 之间自适应：后台线程周期性统计任务的排队等待、执行耗时与线程 CPU 时间，
+// 排队持续偏高时增加线程（任务以 CPU 计算为主时最多增加到 CPU 核数），利用率持续偏低时减少线程
 class ThreadPool {
 public:
-    // 构造函数：创建指定数量的工作线程
-    explicit ThreadPool(size_t thread_count, Logger* logger);
+    ThreadPool(const ThreadPoolOptions& options, Logger* logger);
 
-    // 析构函数：停止所有线程并回收资源
+    // 析构函数：等待已提交的任务执行完毕，停止所有线程并回收资源
     ~ThreadPool();
 
     ThreadPool(const ThreadPool&) = delete;
@@ -23,21 +52,93 @@ public:
     ThreadPool(ThreadPool&&) = delete;
     ThreadPool& operator=(ThreadPool&&) = delete;
 
-    // 提交一个任务给线程池执行
-    void enqueue(std::function<void()> task);
+    // 提交一个任务给线程池执行：工作线程提交时压入自己的队列（不受容量限制，避免工作线程等待自己而死锁），
+    // 其他线程提交时轮转放入各工作线程的收件箱；所有收件箱都已满时返回 false，任务被丢弃
+    [[nodiscard]] bool enqueue(InlineTask task);
+
+    // 当前活跃的工作线程数
+    [[nodiscard]] size_t threadCount() const { return active_.load(std::memory_order_relaxed); }
+
+    // 汇总各线程槽位的队列长度与负载统计（可在任意线程调用，结果为近似值）
+    [[nodiscard]] ThreadPoolStats stats() const;
 
 private:
-    std::vector<std::thread> workers_;  // 工作线程列表
+    // 排队中的任务，记录提交时间用于统计排队等待
+    struct Job {
+        InlineTask task;
+        std::chrono::steady_clock::time_point enqueued;
+    };
+
+    // 每个线程槽位的任务来源与负载统计，按缓存行对齐避免线程之间的伪共享。
+    // 槽位数固定为 max_threads，编号不小于活跃线程数的槽位不再接收轮转提交，其线程处理完自己的任务后退出
+    struct alignas(64) Worker {        // NOLINT(readability-magic-numbers, cppcoreguidelines-avoid-magic-numbers)
+        WorkStealingDeque<Job> deque;  // 工作线程自己提交的任务，只由所属线程压入与弹出，其他线程从另一端窃取
+        MpmcQueue<Job> inbox;          // 外部线程提交的任务，所属线程与空闲线程都可取出
+
+        std::atomic<uint64_t> tasks{0};    // 已执行的任务数
+        std::atomic<uint64_t> wait_ns{0};  // 累计排队等待时间
+        std::atomic<uint64_t> busy_ns{0};  // 累计执行时间
+
+        // 以下字段只在持有 resize_mutex_ 时访问，sampled_* 为上次采样时的统计值与线程 CPU 时间
+        bool running = false;  // 线程是否仍在运行（退出前置为 false）
+        uint64_t sampled_tasks = 0;
+        uint64_t sampled_wait_ns = 0;
+        uint64_t sampled_busy_ns = 0;
+        uint64_t sampled_cpu_ns = 0;
+
+        explicit Worker(const size_t inbox_capacity) : inbox(inbox_capacity) {}
+    };
+
+    // 一个调整周期内的负载
+    struct LoadSample {
+        uint64_t tasks = 0;      // 执行完成的任务数
+        double avg_wait_ms = 0;  // 平均排队等待（毫秒）
+        double utilization = 0;  // 活跃线程忙于执行任务的时间比例
+        double cpu_ratio = 1;    // 执行时间中实际占用 CPU 的比例（偏低说明任务主要在阻塞，如读取磁盘）
+    };
+
+    const size_t min_threads_;
+    const size_t max_threads_;
+    const size_t cpu_count_;  // CPU 核数，任务以计算为主时线程数不超过该值
+
+    std::vector<std::unique_ptr<Worker>> queues_;  // 各线程槽位（数量为 max_threads）
+    std::vector<std::thread> workers_;             // 各槽位的工作线程
+    std::atomic<size_t> active_{0};                // 活跃线程数，编号小于该值的槽位为活跃槽位
     std::atomic<bool> stop_;
+    std::atomic<size_t> next_queue_{0};  // 外部提交的轮转位置
+    EventCount idle_;                    // 空闲线程的休眠与唤醒
 
-    std::queue<std::function<void()>> tasks_;  // 任务队列
-    std::mutex tasks_mutex_;
-    std::condition_variable condition_;
+    std::mutex resize_mutex_;             // 保护线程的启动与退出
+    std::condition_variable control_cv_;  // 唤醒调整线程（停止时）
+    std::thread controller_;              // 调整线程（线程数固定时不启动）
+    size_t congested_intervals_ = 0;      // 连续排队拥塞的周期数
+    size_t idle_intervals_ = 0;           // 连续空闲的周期数
+    std::chrono::steady_clock::time_point last_sample_;
 
     Logger* logger_;  // 日志
 
     // 工作线程主循环函数
     void workerLoop(size_t thread_id);
+
+    // 依次从自己的队列与收件箱、其他线程的队列与收件箱（steal 为 false 时跳过）中取一个任务放入 job，都没有时返回 false
+    bool findTask(size_t thread_id, Job& job, bool steal);
+
+    void runTask(Job& job, size_t thread_id);
+
+    // 退出前确认所在槽位仍为非活跃槽位（可能已被重新启用），返回是否退出
+    bool retire(size_t thread_id);
+
+    // 调整线程主循环：每个周期采样负载并调整线程数
+    void controlLoop();
+
+    // 统计上次采样以来的负载（需持有 resize_mutex_）
+    LoadSample sampleLoad();
+
+    // 根据连续多个周期的负载决定是否调整线程数（需持有 resize_mutex_）
+    void adjust(const LoadSample& sample);
+
+    // 将活跃线程数调整为 count，启动新增槽位的线程（需持有 resize_mutex_）
+    void resize(size_t count);
 };
 
 #endif  // CORE_THREADPOOL_H
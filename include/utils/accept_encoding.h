@@ -0,0 +1,73 @@
+#ifndef UTILS_ACCEPT_ENCODING_H
+#define UTILS_ACCEPT_ENCODING_H
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <string_view>
+#include <system_error>
+
+// Accept-Encoding 头部解析（RFC 9110 12.5.3）
+class AcceptEncoding {
+public:
+    // 客户端对 coding 的接受程度（q 值，0 表示不接受）；未列出的编码按 "*" 处理，均未列出时不接受
+    [[nodiscard]] static double quality(std::string_view accept_encoding, const std::string_view coding) {
+        double wildcard = 0.0;
+        while (!accept_encoding.empty()) {
+            const size_t comma = accept_encoding.find(',');
+            std::string_view element = accept_encoding.substr(0, comma);
+            accept_encoding =
+                comma == std::string_view::npos ? std::string_view{} : accept_encoding.substr(comma + 1);
+
+            // "gzip;q=0.8" 拆分为编码名与参数
+            const size_t semicolon = element.find(';');
+            const std::string_view name = trim(element.substr(0, semicolon));
+            const double q_value =
+                semicolon == std::string_view::npos ? 1.0 : parseQuality(element.substr(semicolon + 1));
+
+            if (equalsIgnoreCase(name, coding)) {
+                return q_value;
+            }
+            if (name == "*") {
+                wildcard = q_value;
+            }
+        }
+        return wildcard;
+    }
+
+private:
+    // 解析 "q=0.5" 形式的参数，格式错误时视为 1
+    [[nodiscard]] static double parseQuality(std::string_view parameter) {
+        parameter = trim(parameter);
+        if (parameter.size() < 2 || (parameter[0] != 'q' && parameter[0] != 'Q') || parameter[1] != '=') {
+            return 1.0;
+        }
+        parameter.remove_prefix(2);
+
+        double q_value = 1.0;
+        const auto [ptr, error] = std::from_chars(parameter.data(), parameter.data() + parameter.size(), q_value);
+        if (error != std::errc{}) {
+            return 1.0;
+        }
+        return std::clamp(q_value, 0.0, 1.0);
+    }
+
+    [[nodiscard]] static std::string_view trim(std::string_view text) {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+            text.remove_prefix(1);
+        }
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+            text.remove_suffix(1);
+        }
+        return text;
+    }
+
+    [[nodiscard]] static bool equalsIgnoreCase(const std::string_view lhs, const std::string_view rhs) {
+        return std::ranges::equal(lhs, rhs, [](const char lhs_char, const char rhs_char) {
+            return std::tolower(static_cast<unsigned char>(lhs_char)) ==
+                   std::tolower(static_cast<unsigned char>(rhs_char));
+        });
+    }
+};
+
+#endif  // UTILS_ACCEPT_ENCODING_H
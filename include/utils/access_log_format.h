@@ -0,0 +1,73 @@
+#ifndef UTILS_ACCESS_LOG_FORMAT_H
+#define UTILS_ACCESS_LOG_FORMAT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// 二进制访问日志的文件格式（由 AccessLog 写入，AccessLogDecode 工具解码）。
+// 布局：AccessLogHeader | 记录流。每条记录以 1 字节类型开头、长度为 8 的倍数；类型为 END（全零）的位置即记录结束，
+// 文件按固定大小预分配，进程异常退出时已写入的记录仍可解码。
+// 字符串（方法、路径）首次出现时写入一条 STRING 记录并分配编号，请求记录只保存编号；编号与时间基准都只在本文件内有效，
+// 每个文件可单独解码。所有整数按本机字节序存储，文件应在同一架构上生成与解码
+
+enum class AccessRecordType : uint8_t {
+    END,      // 未写入的空间
+    STRING,   // AccessStringRecord + length 字节（补齐到 8 的倍数）
+    TIME,     // AccessTimeRecord：重置时间基准（时间倒退或间隔超出 32 位时写入）
+    REQUEST,  // AccessRequestRecord
+};
+
+struct AccessLogHeader {
+    std::array<char, 8> magic{};  // 文件标识（AccessLogFormat::MAGIC）
+    uint32_t version = 0;         // 格式版本
+    uint32_t reserved = 0;        // 保留（补齐）
+    int64_t base_time_us = 0;     // 时间基准（Unix 时间，微秒），第一条请求记录相对它编码
+};
+
+struct AccessStringRecord {
+    AccessRecordType type = AccessRecordType::STRING;
+    uint8_t reserved = 0;
+    uint16_t length = 0;  // 字符串字节数
+    uint32_t id = 0;      // 字符串编号（从 0 开始依次分配）
+};
+
+struct AccessTimeRecord {
+    AccessRecordType type = AccessRecordType::TIME;
+    std::array<uint8_t, 7> reserved{};
+    int64_t time_us = 0;  // 新的时间基准（Unix 时间，微秒）
+};
+
+struct AccessRequestRecord {
+    AccessRecordType type = AccessRecordType::REQUEST;
+    uint8_t reserved = 0;
+    uint16_t status = 0;         // 响应状态码
+    uint32_t time_delta_us = 0;  // 与上一条请求记录（或时间基准）的时间差（微秒）
+    uint32_t client_ip = 0;      // 客户端 IPv4 地址（网络字节序）
+    uint16_t client_port = 0;    // 客户端端口（主机字节序）
+    uint16_t reserved2 = 0;      // 保留（补齐）
+    uint32_t method_id = 0;      // 请求方法的字符串编号
+    uint32_t path_id = 0;        // 请求目标（含查询字符串）的字符串编号
+    uint32_t latency_us = 0;     // 从读到请求到响应进入输出队列的耗时（微秒）
+    uint32_t reserved3 = 0;      // 保留（补齐）
+    uint64_t bytes = 0;          // 响应字节数（头部 + 正文）
+};
+
+static_assert(std::is_trivially_copyable_v<AccessLogHeader> && std::is_trivially_copyable_v<AccessRequestRecord>);
+static_assert(sizeof(AccessLogHeader) == 24 && sizeof(AccessStringRecord) == 8 && sizeof(AccessTimeRecord) == 16 &&
+              sizeof(AccessRequestRecord) == 40);
+
+class AccessLogFormat {
+public:
+    static constexpr std::array<char, 8> MAGIC = {'W', 'S', 'A', 'C', 'C', 'L', 'O', 'G'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t ALIGNMENT = 8;  // 每条记录的长度都是该值的倍数
+
+    // 长度向上补齐到 ALIGNMENT 的倍数
+    [[nodiscard]] static constexpr size_t align(const size_t length) {
+        return (length + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+};
+
+#endif  // UTILS_ACCESS_LOG_FORMAT_H
@@ -0,0 +1,87 @@
+#ifndef UTILS_ARCHIVE_FORMAT_H
+#define UTILS_ARCHIVE_FORMAT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+// 静态资源归档的文件格式（由 PackStatic 工具生成，StaticArchive 映射读取）。
+// 布局：ArchiveHeader | int32 位移表[entry_count] | ArchiveEntry[entry_count] | 数据区（路径、头部、正文）。
+// 所有整数按本机字节序存储，所有偏移均相对于文件起始位置，归档应在同一架构上生成与使用
+
+// 文件内的字节区间
+struct ArchiveSpan {
+    uint64_t offset = 0;  // 起始偏移
+    uint64_t length = 0;  // 长度
+};
+
+// 资源的一种表示（原始内容或压缩变体），头部在打包时按 StaticFile 的格式序列化好
+struct ArchiveRepresentation {
+    ArchiveSpan header;        // 200 状态行与头部（不含 Connection 与结尾空行），长度为 0 表示该表示不存在
+    ArchiveSpan not_modified;  // 304 状态行与头部
+    ArchiveSpan body;          // 正文
+    ArchiveSpan etag;          // ETag 值（位于 header 内）
+    ArchiveSpan content_type;  // Content-Type 值（位于 header 内）
+};
+
+// 位移表中的一个槽位对应一个资源
+struct ArchiveEntry {
+    // 表示的下标
+    enum : uint8_t {
+        IDENTITY,
+        GZIP,
+        BROTLI,
+        REPRESENTATION_COUNT,
+    };
+
+    ArchiveSpan path;                                                         // 相对于静态根目录的路径（如 images/a.png）
+    int64_t modified_time = 0;                                                // 最后修改时间（秒）
+    std::array<ArchiveRepresentation, REPRESENTATION_COUNT> representations;  // 各表示
+};
+
+struct ArchiveHeader {
+    std::array<char, 8> magic{};        // 文件标识（ArchiveFormat::MAGIC）
+    uint32_t version = 0;               // 格式版本
+    uint32_t entry_count = 0;           // 资源数，同时也是位移表与条目表的长度
+    uint64_t displacements_offset = 0;  // 位移表的偏移
+    uint64_t entries_offset = 0;        // 条目表的偏移
+};
+
+static_assert(std::is_trivially_copyable_v<ArchiveHeader> && std::is_trivially_copyable_v<ArchiveEntry>);
+
+// 归档的完美哈希（hash and displace）：路径先按种子 0 哈希到桶，桶的位移值 d 决定最终槽位——
+// d > 0 时槽位为 hash(d, path) % n，d < 0 时槽位直接为 -d - 1，查找只需一次探测与一次路径比较
+class ArchiveFormat {
+public:
+    static constexpr std::array<char, 8> MAGIC = {'W', 'S', 'A', 'R', 'C', 'H', 'I', 'V'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t ALIGNMENT = alignof(ArchiveEntry);  // 位移表与条目表的对齐
+
+    // 带种子的 FNV-1a 64 位哈希，末尾做一次混合以改善低位分布
+    [[nodiscard]] static uint64_t hash(const uint32_t seed, const std::string_view key) {
+        constexpr uint64_t offset_basis = 0xcbf29ce484222325ULL;
+        constexpr uint64_t prime = 0x100000001b3ULL;
+        constexpr uint64_t seed_multiplier = 0x9e3779b97f4a7c15ULL;
+
+        uint64_t hash = offset_basis ^ (seed * seed_multiplier);
+        for (const char c : key) {  // NOLINT(readability-identifier-length)
+            hash = (hash ^ static_cast<unsigned char>(c)) * prime;
+        }
+        return hash ^ (hash >> 32U);  // NOLINT(readability-magic-numbers, cppcoreguidelines-avoid-magic-numbers)
+    }
+
+    // 路径所在的槽位（不在归档中的路径也会得到一个槽位，需要再比较路径）
+    [[nodiscard]] static size_t slotOf(const std::span<const int32_t> displacements, const std::string_view key) {
+        const size_t count = displacements.size();
+        const int32_t displacement = displacements[hash(0, key) % count];
+        if (displacement < 0) {
+            return static_cast<size_t>(-static_cast<int64_t>(displacement) - 1);
+        }
+        return hash(static_cast<uint32_t>(displacement), key) % count;
+    }
+};
+
+#endif  // UTILS_ARCHIVE_FORMAT_H
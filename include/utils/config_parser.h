@@ -2,6 +2,7 @@
 #define UTILS_CONFIG_PARSER_H
 
 #include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -58,6 +59,18 @@ public:
         return LogLevel::INFO;  // 默认值
     }
 
+    LogOverflowPolicy getLogOverflowPolicy() const {
+        std::string value = get("log_overflow", std::string("drop"));
+        if (value == "block") {
+            return LogOverflowPolicy::BLOCK;
+        }
+        if (value == "sample") {
+            return LogOverflowPolicy::SAMPLE;
+        }
+
+        return LogOverflowPolicy::DROP;  // 默认值
+    }
+
 private:
     std::unordered_map<std::string, std::string> config_map_;
     std::filesystem::path config_file_;
@@ -0,0 +1,60 @@
+#ifndef UTILS_ETAG_H
+#define UTILS_ETAG_H
+
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include <sys/stat.h>
+
+// 实体标签（RFC 9110 8.8.3）的生成与比较
+class ETag {
+public:
+    // 由文件大小与纳秒级修改时间生成强 ETag（如 "3b3-1835e0d7a1c5f200"）
+    [[nodiscard]] static std::string fromStat(const struct stat& file_stat) {
+        constexpr uint64_t nanoseconds_per_second = 1000000000;
+        const auto mtime_ns = (static_cast<uint64_t>(file_stat.st_mtim.tv_sec) * nanoseconds_per_second) +
+                              static_cast<uint64_t>(file_stat.st_mtim.tv_nsec);
+        return std::format("\"{:x}-{:x}\"", file_stat.st_size, mtime_ns);
+    }
+
+    // 由内容生成强 ETag（用于目录列表等没有对应文件的响应），内容相同则 ETag 相同
+    [[nodiscard]] static std::string fromContent(const std::string_view content) {
+        return std::format("\"{:x}-{:x}\"", content.size(), std::hash<std::string_view>{}(content));
+    }
+
+    // 同一资源的其他表示（如压缩变体）必须使用不同的强 ETag，在引号内追加后缀（如 "-gzip"）
+    [[nodiscard]] static std::string withSuffix(const std::string_view etag, const std::string_view suffix) {
+        std::string result(etag.substr(0, etag.size() - 1));
+        result.append(suffix).push_back('"');
+        return result;
+    }
+
+    // If-None-Match 头部中是否有与 etag 匹配的实体标签：弱比较，忽略 W/ 前缀，"*" 匹配任意资源
+    [[nodiscard]] static bool matchesAny(std::string_view header_value, const std::string_view etag) {
+        while (!header_value.empty()) {
+            const size_t comma = header_value.find(',');
+            std::string_view candidate = header_value.substr(0, comma);
+            header_value = comma == std::string_view::npos ? std::string_view{} : header_value.substr(comma + 1);
+
+            while (!candidate.empty() && (candidate.front() == ' ' || candidate.front() == '\t')) {
+                candidate.remove_prefix(1);
+            }
+            while (!candidate.empty() && (candidate.back() == ' ' || candidate.back() == '\t')) {
+                candidate.remove_suffix(1);
+            }
+            if (candidate.starts_with("W/")) {
+                candidate.remove_prefix(2);
+            }
+
+            if (candidate == "*" || candidate == etag) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+#endif  // UTILS_ETAG_H
@@ -0,0 +1,52 @@
+#ifndef UTILS_EVENT_COUNT_H
+#define UTILS_EVENT_COUNT_H
+
+#include <atomic>
+#include <cstdint>
+
+// 事件计数器：让空闲线程在"检查条件 → 休眠"之间不丢失唤醒，且没有等待者时通知只需一次原子读取。
+// 等待方：key = prepareWait()，再次检查条件，仍不满足时 wait(key)，否则 cancelWait()；
+// 通知方：先让条件成立（如压入任务），再调用 notifyOne / notifyAll。
+// 休眠基于 C++20 的 std::atomic::wait（Linux 上为 futex），不需要互斥锁
+class EventCount {
+public:
+    [[nodiscard]] uint32_t prepareWait() {
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        return epoch_.load(std::memory_order_seq_cst);
+    }
+
+    void cancelWait() { waiters_.fetch_sub(1, std::memory_order_relaxed); }
+
+    // 在 prepareWait 之后没有发生过通知时休眠
+    void wait(const uint32_t key) {
+        epoch_.wait(key, std::memory_order_seq_cst);
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void notifyOne() {
+        if (hasWaiters()) {
+            epoch_.fetch_add(1, std::memory_order_seq_cst);
+            epoch_.notify_one();
+        }
+    }
+
+    void notifyAll() {
+        if (hasWaiters()) {
+            epoch_.fetch_add(1, std::memory_order_seq_cst);
+            epoch_.notify_all();
+        }
+    }
+
+private:
+    std::atomic<uint32_t> epoch_{0};    // 每次通知递增，等待者据此判断是否错过了通知
+    std::atomic<uint32_t> waiters_{0};  // 已进入等待流程的线程数
+
+    // 与等待方的 fetch_add 构成 Dekker 式同步：条件的写入对随后进入等待流程的线程可见，
+    // 或者通知方一定能看到该等待者
+    [[nodiscard]] bool hasWaiters() const {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return waiters_.load(std::memory_order_relaxed) > 0;
+    }
+};
+
+#endif  // UTILS_EVENT_COUNT_H
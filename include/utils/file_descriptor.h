@@ -0,0 +1,42 @@
+#ifndef UTILS_FILE_DESCRIPTOR_H
+#define UTILS_FILE_DESCRIPTOR_H
+
+#include <utility>
+
+#include <unistd.h>
+
+// 文件描述符的 RAII 封装：析构时自动关闭
+class FileDescriptor {
+public:
+    explicit FileDescriptor(const int file_fd = -1) : fd_(file_fd) {}
+
+    ~FileDescriptor() {
+        if (fd_ != -1) {
+            close(fd_);
+        }
+    }
+
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+    FileDescriptor(FileDescriptor&& other) noexcept : fd_(std::exchange(other.fd_, -1)) {}
+
+    FileDescriptor& operator=(FileDescriptor&& other) noexcept {
+        if (this != &other) {
+            if (fd_ != -1) {
+                close(fd_);
+            }
+            fd_ = std::exchange(other.fd_, -1);
+        }
+        return *this;
+    }
+
+    [[nodiscard]] int get() const { return fd_; }
+
+    [[nodiscard]] bool valid() const { return fd_ != -1; }
+
+private:
+    int fd_;
+};
+
+#endif  // UTILS_FILE_DESCRIPTOR_H
@@ -0,0 +1,47 @@
+#ifndef UTILS_GZIP_H
+#define UTILS_GZIP_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <zlib.h>
+
+// 基于 zlib 的 gzip 压缩（RFC 1952），一次性压缩内存中的完整数据
+class Gzip {
+public:
+    static constexpr size_t MIN_INPUT_SIZE = 256;             // 小于该字节数的数据压缩收益不足以抵消头部开销
+    static constexpr std::string_view ETAG_SUFFIX = "-gzip";  // 运行时压缩的变体在原 ETag 上追加的后缀
+
+    // 压缩数据，失败时抛出异常
+    [[nodiscard]] static std::string compress(const std::string_view data, const int level = Z_BEST_COMPRESSION) {
+        constexpr int window_bits = MAX_WBITS + 16;  // 加 16 表示输出 gzip 格式的头部与尾部
+        constexpr int mem_level = 8;                 // zlib 默认的内存级别
+
+        z_stream stream{};
+        if (deflateInit2(&stream, level, Z_DEFLATED, window_bits, mem_level, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::runtime_error("Failed to initialize gzip stream.");
+        }
+
+        // deflateBound 给出的上限足以一次完成压缩
+        std::string output(deflateBound(&stream, data.size()), '\0');
+        // zlib 的输入指针不是 const，但不会修改输入数据
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast, cppcoreguidelines-pro-type-const-cast)
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        stream.avail_in = static_cast<uInt>(data.size());
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        stream.next_out = reinterpret_cast<Bytef*>(output.data());
+        stream.avail_out = static_cast<uInt>(output.size());
+
+        const int result = deflate(&stream, Z_FINISH);
+        output.resize(stream.total_out);
+        deflateEnd(&stream);
+        if (result != Z_STREAM_END) {
+            throw std::runtime_error("Failed to gzip data.");
+        }
+        return output;
+    }
+};
+
+#endif  // UTILS_GZIP_H
@@ -0,0 +1,34 @@
+#ifndef UTILS_HTTP_DATE_H
+#define UTILS_HTTP_DATE_H
+
+#include <array>
+#include <ctime>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// HTTP 日期（RFC 9110 IMF-fixdate，如 "Sun, 06 Nov 1994 08:49:37 GMT"）与 time_t 之间的转换
+class HttpDate {
+public:
+    [[nodiscard]] static std::string format(const std::time_t time) {
+        std::tm utc_time{};
+        gmtime_r(&time, &utc_time);
+
+        std::array<char, 32> buffer{};  // NOLINT(readability-magic-numbers, cppcoreguidelines-avoid-magic-numbers)
+        const size_t length = strftime(buffer.data(), buffer.size(), "%a, %d %b %Y %H:%M:%S GMT", &utc_time);
+        return {buffer.data(), length};
+    }
+
+    // 解析 IMF-fixdate，格式不符时返回 std::nullopt
+    [[nodiscard]] static std::optional<std::time_t> parse(const std::string_view date) {
+        const std::string text(date);
+        std::tm utc_time{};
+        const char* end = strptime(text.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &utc_time);
+        if (end == nullptr || *end != '\0') {
+            return std::nullopt;
+        }
+        return timegm(&utc_time);
+    }
+};
+
+#endif  // UTILS_HTTP_DATE_H
@@ -0,0 +1,89 @@
+#ifndef UTILS_INLINE_TASK_H
+#define UTILS_INLINE_TASK_H
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// 只可移动的任务对象：闭包直接构造在对象内部的固定缓冲区中，不进行堆分配（替代 std::function<void()>）。
+// 闭包超出 CAPACITY、对齐要求过高或移动可能抛出异常时编译失败，而不是退化为堆分配
+class InlineTask {
+public:
+    static constexpr size_t CAPACITY = 48;  // 内联缓冲区字节数，可容纳捕获数个指针或 shared_ptr 的闭包
+
+    InlineTask() = default;
+
+    // 允许 lambda 隐式转换，调用方可以直接传入闭包
+    template <typename Func>
+        requires(!std::same_as<std::decay_t<Func>, InlineTask> && std::invocable<std::decay_t<Func>&>)
+    InlineTask(Func&& func) {  // NOLINT(google-explicit-constructor, hicpp-explicit-conversions)
+        using Callable = std::decay_t<Func>;
+        static_assert(sizeof(Callable) <= CAPACITY, "Closure is too large for InlineTask.");
+        static_assert(alignof(Callable) <= alignof(std::max_align_t), "Closure is over-aligned for InlineTask.");
+        static_assert(std::is_nothrow_move_constructible_v<Callable>, "Closure must be nothrow move constructible.");
+
+        ::new (static_cast<void*>(storage_.data())) Callable(std::forward<Func>(func));
+        ops_ = &OPS<Callable>;
+    }
+
+    InlineTask(InlineTask&& other) noexcept { moveFrom(other); }
+
+    InlineTask& operator=(InlineTask&& other) noexcept {
+        if (this != &other) {
+            reset();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    InlineTask(const InlineTask&) = delete;
+    InlineTask& operator=(const InlineTask&) = delete;
+
+    ~InlineTask() { reset(); }
+
+    [[nodiscard]] explicit operator bool() const { return ops_ != nullptr; }
+
+    // 执行任务（不能为空）
+    void operator()() { ops_->invoke(storage_.data()); }
+
+    // 销毁闭包（释放其捕获的资源），之后为空
+    void reset() {
+        if (ops_ != nullptr) {
+            ops_->destroy(storage_.data());
+            ops_ = nullptr;
+        }
+    }
+
+private:
+    // 按闭包类型生成的操作表，代替虚函数
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*move)(void* target, void* source) noexcept;  // 移动构造到 target 并销毁 source
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template <typename Callable>
+    static constexpr Ops OPS{
+        [](void* storage) { (*static_cast<Callable*>(storage))(); },
+        [](void* target, void* source) noexcept {
+            ::new (target) Callable(std::move(*static_cast<Callable*>(source)));
+            static_cast<Callable*>(source)->~Callable();
+        },
+        [](void* storage) noexcept { static_cast<Callable*>(storage)->~Callable(); },
+    };
+
+    alignas(std::max_align_t) std::array<std::byte, CAPACITY> storage_{};  // 闭包的内联存储
+    const Ops* ops_ = nullptr;                                              // 为空时表示没有任务
+
+    void moveFrom(InlineTask& other) noexcept {
+        if (other.ops_ != nullptr) {
+            other.ops_->move(storage_.data(), other.storage_.data());
+            ops_ = std::exchange(other.ops_, nullptr);
+        }
+    }
+};
+
+#endif  // UTILS_INLINE_TASK_H
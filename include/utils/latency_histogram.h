@@ -0,0 +1,114 @@
+#ifndef UTILS_LATENCY_HISTOGRAM_H
+#define UTILS_LATENCY_HISTOGRAM_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// 延迟直方图的分桶（HDR 风格的对数线性分桶）：小于 8 的值各占一个桶，之后每个 2 的幂区间等分为 8 个桶，
+// 桶宽不超过下界的 12.5%，共 240 个桶覆盖 0 到 2^32 - 1（以微秒计约 71 分钟）。2 的幂恰好落在桶边界上
+class LatencyBuckets {
+public:
+    static constexpr size_t SUB_BUCKET_BITS = 3;
+    static constexpr uint64_t SUB_BUCKETS = uint64_t{1} << SUB_BUCKET_BITS;  // 每个 2 的幂区间的桶数
+    static constexpr size_t VALUE_BITS = 32;
+    static constexpr uint64_t MAX_VALUE = (uint64_t{1} << VALUE_BITS) - 1;  // 更大的值计入最后一个桶
+    static constexpr size_t COUNT = (VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    // 值所在桶的编号
+    [[nodiscard]] static constexpr size_t indexOf(uint64_t value) {
+        value = std::min(value, MAX_VALUE);
+        if (value < SUB_BUCKETS) {
+            return static_cast<size_t>(value);
+        }
+        const size_t shift = static_cast<size_t>(std::bit_width(value)) - 1 - SUB_BUCKET_BITS;
+        return ((shift + 1) * SUB_BUCKETS) + static_cast<size_t>((value >> shift) - SUB_BUCKETS);
+    }
+
+    // 桶的下界（含）
+    [[nodiscard]] static constexpr uint64_t lowerBound(const size_t index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+        const size_t shift = (index / SUB_BUCKETS) - 1;
+        return (SUB_BUCKETS + (index % SUB_BUCKETS)) << shift;
+    }
+
+    // 桶的上界（不含）
+    [[nodiscard]] static constexpr uint64_t upperBound(const size_t index) {
+        if (index < SUB_BUCKETS) {
+            return index + 1;
+        }
+        return lowerBound(index) + (uint64_t{1} << ((index / SUB_BUCKETS) - 1));
+    }
+};
+
+static_assert(LatencyBuckets::indexOf(LatencyBuckets::MAX_VALUE) == LatencyBuckets::COUNT - 1);
+static_assert(LatencyBuckets::upperBound(LatencyBuckets::COUNT - 1) == LatencyBuckets::MAX_VALUE + 1);
+
+// 合并后的直方图（普通整数，只在抓取时构造）
+struct LatencySnapshot {
+    std::array<uint64_t, LatencyBuckets::COUNT> counts{};  // 各桶的计数
+    uint64_t count = 0;                                    // 总次数
+    uint64_t sum = 0;                                      // 所有值之和
+
+    // 小于 bound 的值的个数，bound 须为桶边界（如 2 的幂）
+    [[nodiscard]] uint64_t countBelow(const uint64_t bound) const {
+        uint64_t total = 0;
+        for (size_t i = 0; i < LatencyBuckets::COUNT && LatencyBuckets::upperBound(i) <= bound; ++i) {
+            total += counts.at(i);
+        }
+        return total;
+    }
+
+    // 分位数（quantile 取 0 到 1），返回所在桶内的最大值，即不小于真实值的估计；没有数据时返回 0
+    [[nodiscard]] uint64_t quantile(const double quantile) const {
+        if (count == 0) {
+            return 0;
+        }
+        const auto rank =
+            std::max<uint64_t>(static_cast<uint64_t>(std::ceil(quantile * static_cast<double>(count))), 1);
+        uint64_t total = 0;
+        for (size_t i = 0; i < LatencyBuckets::COUNT; ++i) {
+            total += counts.at(i);
+            if (total >= rank) {
+                return LatencyBuckets::upperBound(i) - 1;
+            }
+        }
+        return LatencyBuckets::MAX_VALUE;
+    }
+};
+
+// 单写者延迟直方图：只由所属线程调用 record（普通的读取加写入，无需原子读改写指令），
+// 其他线程可随时调用 mergeInto 读取，读到的是某个时刻前后的近似值
+class LatencyHistogram {
+public:
+    void record(const uint64_t value) {
+        increment(counts_.at(LatencyBuckets::indexOf(value)), 1);
+        increment(sum_, value);
+    }
+
+    // 将本直方图累加到 snapshot
+    void mergeInto(LatencySnapshot& snapshot) const {
+        for (size_t i = 0; i < LatencyBuckets::COUNT; ++i) {
+            const uint64_t count = counts_.at(i).load(std::memory_order_relaxed);
+            snapshot.counts.at(i) += count;
+            snapshot.count += count;
+        }
+        snapshot.sum += sum_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, LatencyBuckets::COUNT> counts_{};
+    std::atomic<uint64_t> sum_{0};
+
+    static void increment(std::atomic<uint64_t>& counter, const uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+};
+
+#endif  // UTILS_LATENCY_HISTOGRAM_H
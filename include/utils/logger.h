@@ -1,9 +1,19 @@
 #ifndef UTILS_LOGGER_H
 #define UTILS_LOGGER_H
 
-#include <fstream>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "utils/file_descriptor.h"
 
 enum class LogLevel : std::uint8_t {
     DEBUG,
@@ -12,15 +22,54 @@ enum class LogLevel : std::uint8_t {
     ERROR,
 };
 
+// 异步模式下线程缓冲区已满时的处理策略
+enum class LogOverflowPolicy : std::uint8_t {
+    DROP,    // 丢弃新记录并计数，由后台线程定期写入丢弃条数
+    BLOCK,   // 等待后台线程腾出空间（请求线程可能被阻塞）
+    SAMPLE,  // 缓冲区过半后 DEBUG / INFO 记录按比例采样，WARNING / ERROR 只在缓冲区写满时丢弃
+};
+
+// 日志的可配置参数
+struct LoggerOptions {
+    bool async = false;                                    // 异步模式：调用线程只写入自己的环形缓冲区，由后台线程批量写入文件
+    size_t buffer_bytes = 262144;                          // 异步模式下每个线程的环形缓冲区字节数（向上取整为 2 的幂）
+    LogOverflowPolicy overflow = LogOverflowPolicy::DROP;  // 缓冲区已满时的处理策略
+    size_t sample_rate = 10;                               // SAMPLE 策略下每 N 条 DEBUG / INFO 记录保留一条
+    std::chrono::milliseconds flush_interval{100};         // 后台线程批量写入的周期
+    std::chrono::milliseconds fsync_interval{1000};        // 后台线程调用 fdatasync 的周期（0 表示不主动同步）
+};
+
+// 编译期最低日志等级（0=DEBUG 1=INFO 2=WARNING 3=ERROR），低于该等级的 LOG 语句连同参数在编译时被移除
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL 0  // NOLINT(cppcoreguidelines-macro-usage)
+#endif
+inline constexpr auto LOG_COMPILE_MIN_LEVEL = static_cast<LogLevel>(LOG_COMPILE_LEVEL);
+
+// 写入一条日志：等级低于编译期或运行时的最低等级时不求值其余参数（不格式化消息、不拷贝路径），
+// 运行时只有一次等级比较。level 必须为常量（如 LogLevel::DEBUG），用法：LOG(logger_, LogLevel::DEBUG, info_, std::format(...))
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define LOG(logger, level, ...)                           \
+    do {                                                  \
+        if constexpr ((level) >= LOG_COMPILE_MIN_LEVEL) { \
+            if ((logger)->enabled(level)) {               \
+                (logger)->log(level, __VA_ARGS__);        \
+            }                                             \
+        }                                                 \
+    } while (false)
+
 // 前向声明
 class Address;
+class LogRingBuffer;
 
+// 日志：按日期写入 log_YYYY-MM-DD.log。
+// 同步模式下每条记录在锁内直接 write 到文件；异步模式下调用线程把格式化好的记录追加到自己的无锁环形缓冲区，
+// 后台线程周期性地收集所有缓冲区，合并为一次 write 写入文件，并负责日期轮换与定期 fdatasync
 class Logger {
 public:
-    // 构造函数：打开日志文件并设置最低日志等级
-    explicit Logger(LogLevel min_level = LogLevel::INFO);
+    // 构造函数：打开日志文件并设置最低日志等级，异步模式下启动后台写入线程
+    explicit Logger(LogLevel min_level = LogLevel::INFO, const LoggerOptions& options = {});
 
-    // 析构函数：确保日志文件关闭
+    // 析构函数：写入缓冲区中剩余的记录并关闭日志文件
     ~Logger();
 
     Logger(const Logger&) = delete;
@@ -32,26 +81,61 @@ public:
     void log(LogLevel level, const std::string& message);
     void log(LogLevel level, const Address& address, const std::string& message);
 
+    // 该等级的日志是否会被记录（供 LOG 宏在格式化消息之前判断）
+    [[nodiscard]] bool enabled(const LogLevel level) const { return level >= min_level_; }
+
     // 写入一条分隔符
     void logDivider(const std::string& title, LogLevel level = LogLevel::INFO);
 
 private:
-    std::ofstream file_;
+    FileDescriptor file_;
     std::string filename_;
-    std::mutex mutex_;
+    std::chrono::system_clock::time_point next_rotation_;  // 下一次日期轮换的时间（本地时间的次日零点）
+    std::mutex mutex_;                                     // 保护文件写入与轮换
     LogLevel min_level_;
+    LoggerOptions options_;
+
+    // 异步模式
+    const uint64_t instance_id_;                          // 实例编号，线程缓存的缓冲区据此判断归属
+    std::vector<std::shared_ptr<LogRingBuffer>> buffers_;  // 各线程的缓冲区（线程退出后由后台线程回收）
+    std::mutex buffers_mutex_;                            // 保护 buffers_
+    std::atomic<uint64_t> dropped_{0};                    // 因缓冲区已满丢弃的记录数
+    std::atomic<uint64_t> sampled_out_{0};                // 因采样丢弃的记录数
+    std::atomic<bool> flush_requested_{false};            // 有缓冲区超过半满，请求后台线程提前写入
+    std::atomic<bool> stopping_{false};
+    std::mutex flush_mutex_;
+    std::condition_variable flush_cv_;
+    std::thread flusher_;
+
+    // 按同步或异步模式提交一条格式化好的记录
+    void submit(LogLevel level, std::string_view line);
+
+    // 追加到当前线程的缓冲区，按策略处理缓冲区已满的情况
+    void append(LogLevel level, std::string_view line);
+
+    // 当前线程在本实例中的缓冲区，首次调用时创建并登记
+    LogRingBuffer& threadBuffer();
+
+    // 后台线程主循环
+    void flushLoop();
+
+    // 收集所有缓冲区中的记录追加到 batch，并回收已退出线程的空缓冲区
+    void drainBuffers(std::string& batch);
+
+    // 写入文件（必要时先轮换）
+    void writeToFile(std::string_view data);
 
-    // 基于当前日期生成日志文件名
-    [[nodiscard]] static std::string generateLogFilename();
+    // 基于当前日期生成日志文件名，并给出下一次轮换的时间
+    [[nodiscard]] static std::string generateLogFilename(std::chrono::system_clock::time_point& next_rotation);
 
-    // 日期轮换
+    // 日期轮换（需持有 mutex_）
     void rotateIfNeeded();
 
-    // 获取当前时间
-    [[nodiscard]] static std::string currentTime();
+    // 获取当前时间（每个线程缓存格式化结果，每秒只格式化一次；返回值在本线程下次调用前有效）
+    [[nodiscard]] static std::string_view currentTime();
 
     // 将日志等级枚举值转换为字符串形式
-    [[nodiscard]] static std::string logLevelToString(LogLevel level);
+    [[nodiscard]] static std::string_view logLevelToString(LogLevel level);
 };
 
 #endif  // UTILS_LOGGER_H
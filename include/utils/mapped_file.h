@@ -0,0 +1,54 @@
+#ifndef UTILS_MAPPED_FILE_H
+#define UTILS_MAPPED_FILE_H
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <string_view>
+
+#include <sys/mman.h>
+
+// 文件的只读内存映射：映射与页缓存共享物理页，多个进程映射同一文件时不额外占用内存。
+// 映射期间文件被原地截断时，用户态读取超出新长度的页会触发 SIGBUS（进程退出），经 write / writev 等系统调用读取只返回 EFAULT；
+// 映射仍在使用的文件应以写入临时文件再 rename 的方式替换
+class MappedFile {
+public:
+    // 映射文件的 [0, size) 区间，失败时抛出异常；populate 为 true 时立即读入全部页，
+    // 为 false 时只发起异步预读，映射本身不随文件大小增加耗时
+    MappedFile(const int file_fd, const size_t size, const bool populate = true) : size_(size) {
+        if (size_ == 0) {
+            throw std::runtime_error("Cannot map an empty file.");
+        }
+
+        const int flags = populate ? MAP_SHARED | MAP_POPULATE : MAP_SHARED;
+        void* addr = mmap(nullptr, size_, PROT_READ, flags, file_fd, 0);
+        if (addr == MAP_FAILED) {
+            throw std::runtime_error(std::format("Failed to mmap file: {}", strerror(errno)));
+        }
+        data_ = static_cast<const char*>(addr);
+
+        // 映射的内容会被反复读取，提示内核尽量预读并保留这些页
+        madvise(addr, size_, MADV_WILLNEED);
+    }
+
+    ~MappedFile() {
+        munmap(const_cast<char*>(data_), size_);  // NOLINT(cppcoreguidelines-pro-type-const-cast)
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&&) = delete;
+    MappedFile& operator=(MappedFile&&) = delete;
+
+    [[nodiscard]] std::string_view view() const { return {data_, size_}; }
+
+    [[nodiscard]] size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;  // 映射起始地址
+    size_t size_;                 // 映射长度
+};
+
+#endif  // UTILS_MAPPED_FILE_H
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <filesystem>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 namespace detail {
@@ -46,11 +47,21 @@ namespace detail {
         }
         return "application/octet-stream";
     }
+
+    // 文本类资源压缩率高，值得压缩；图片、音视频与压缩包本身已压缩
+    [[nodiscard]] inline bool isCompressible(std::string_view type) {
+        type = type.substr(0, type.find(';'));
+        return type.starts_with("text/") || type == "application/javascript" || type == "application/json" ||
+               type == "application/xml" || type == "image/svg+xml";
+    }
 }  // namespace detail
 
 class MimeType {
 public:
     [[nodiscard]] static std::string get(const std::filesystem::path& path) { return detail::getMime(path); }
+
+    // 该类型的内容是否适合 gzip 压缩
+    [[nodiscard]] static bool isCompressible(const std::string_view type) { return detail::isCompressible(type); }
 };
 
 #endif  // UTILS_MIME_TYPE_H
@@ -0,0 +1,102 @@
+#ifndef UTILS_MPMC_QUEUE_H
+#define UTILS_MPMC_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+// 有界无锁多生产者多消费者环形队列（Vyukov 算法）：每个槽位带一个序号，生产者与消费者各自以 CAS 认领位置，
+// 元素直接存放在槽位中，入队与出队都不分配内存；队列满时 tryPush 立即失败，由调用方决定丢弃或重试。
+// T 需要可默认构造与无异常移动赋值
+template <typename T>
+class MpmcQueue {
+public:
+    // 容量向上取整为 2 的幂（至少为 2）
+    explicit MpmcQueue(const size_t capacity)
+        : mask_(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1), slots_(std::make_unique<Slot[]>(mask_ + 1)) {
+        for (size_t i = 0; i <= mask_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+    MpmcQueue(MpmcQueue&&) = delete;
+    MpmcQueue& operator=(MpmcQueue&&) = delete;
+    ~MpmcQueue() = default;
+
+    // 入队，队列已满时返回 false 且 item 保持不变
+    bool tryPush(T& item) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        while (true) {
+            slot = &slots_[pos & mask_];
+            const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // 槽位仍未被消费：队列已满
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);  // 被其他生产者抢先
+            }
+        }
+        slot->value = std::move(item);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 出队，队列为空时返回 false
+    bool tryPop(T& item) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        Slot* slot = nullptr;
+        while (true) {
+            slot = &slots_[pos & mask_];
+            const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // 槽位尚未写入：队列为空
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);  // 被其他消费者抢先
+            }
+        }
+        item = std::move(slot->value);
+        slot->sequence.store(pos + mask_ + 1, std::memory_order_release);  // 槽位留给下一圈的生产者
+        return true;
+    }
+
+    [[nodiscard]] size_t capacity() const { return mask_ + 1; }
+
+    // 近似的元素个数（并发修改时只作参考）
+    [[nodiscard]] size_t size() const {
+        const size_t dequeue_pos = dequeue_pos_.load(std::memory_order_relaxed);
+        const size_t enqueue_pos = enqueue_pos_.load(std::memory_order_relaxed);
+        return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;  // 等于 pos 时可写入，等于 pos + 1 时可读取
+        T value;
+    };
+
+    const size_t mask_;
+    std::unique_ptr<Slot[]> slots_;  // NOLINT(cppcoreguidelines-avoid-c-arrays, hicpp-avoid-c-arrays)
+
+    // 生产者与消费者的位置分处不同的缓存行
+    // NOLINTNEXTLINE(readability-magic-numbers, cppcoreguidelines-avoid-magic-numbers)
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    // NOLINTNEXTLINE(readability-magic-numbers, cppcoreguidelines-avoid-magic-numbers)
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+};
+
+#endif  // UTILS_MPMC_QUEUE_H
@@ -0,0 +1,35 @@
+#ifndef UTILS_OPENAT2_H
+#define UTILS_OPENAT2_H
+
+#include <cerrno>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <linux/openat2.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// openat2 系统调用（Linux 5.6+）的封装，glibc 未提供包装函数。
+// resolve 标志由内核在路径解析过程中强制执行，如 RESOLVE_BENEATH 保证解析结果不会越出 dir_fd 所指的目录
+class OpenAt2 {
+public:
+    // 成功时返回文件描述符，失败时返回 -1 并设置 errno（内核不支持时为 ENOSYS）
+    [[nodiscard]] static int open(const int dir_fd, const char* path, const int flags, const uint64_t resolve) {
+        open_how how{};
+        how.flags = static_cast<uint64_t>(flags);
+        how.resolve = resolve;
+        return static_cast<int>(syscall(SYS_openat2, dir_fd, path, &how, sizeof(how)));
+    }
+
+    // 内核是否支持 openat2（容器的 seccomp 策略也可能拒绝未知的系统调用）
+    [[nodiscard]] static bool supported(const int dir_fd) {
+        const int file_fd = open(dir_fd, ".", O_PATH | O_CLOEXEC, RESOLVE_BENEATH);
+        if (file_fd == -1) {
+            return errno != ENOSYS && errno != EPERM;
+        }
+        close(file_fd);
+        return true;
+    }
+};
+
+#endif  // UTILS_OPENAT2_H
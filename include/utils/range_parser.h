@@ -0,0 +1,140 @@
+#ifndef UTILS_RANGE_PARSER_H
+#define UTILS_RANGE_PARSER_H
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+// 字节范围（已根据资源大小截断，length 大于 0）
+struct ByteRange {
+    size_t offset = 0;  // 起始偏移
+    size_t length = 0;  // 长度
+};
+
+// Range 请求头部解析（RFC 9110 14.1.2），只支持 bytes 单位
+class RangeParser {
+public:
+    enum class Status : std::uint8_t {
+        IGNORED,        // 语法无效、单位不支持或范围不合理，按完整响应处理
+        SATISFIABLE,    // 至少有一个范围可满足
+        UNSATISFIABLE,  // 所有范围的起点都超出资源大小，应返回 416
+    };
+
+    struct Result {
+        Status status = Status::IGNORED;
+        std::vector<ByteRange> ranges;  // 可满足的范围（保持请求中的顺序）
+    };
+
+    static constexpr size_t MAX_RANGES = 16;  // 单个请求最多允许的范围数
+
+    // 解析 "bytes=0-99, 200-, -500" 形式的头部值，size 为资源大小
+    [[nodiscard]] static Result parse(std::string_view value, const size_t size) {
+        constexpr std::string_view unit = "bytes=";
+        if (value.size() < unit.size() || !equalsIgnoreCase(value.substr(0, unit.size()), unit)) {
+            return {};
+        }
+        value.remove_prefix(unit.size());
+
+        Result result;
+        size_t spec_count = 0;
+        size_t total_length = 0;
+        while (!value.empty()) {
+            const size_t comma = value.find(',');
+            const std::string_view spec = trim(value.substr(0, comma));
+            value = comma == std::string_view::npos ? std::string_view{} : value.substr(comma + 1);
+            if (spec.empty()) {
+                continue;  // 允许空列表元素（如 "0-1,,2-3"）
+            }
+
+            if (++spec_count > MAX_RANGES) {
+                return {};
+            }
+
+            const size_t dash = spec.find('-');
+            if (dash == std::string_view::npos) {
+                return {};
+            }
+            const std::string_view first_text = trim(spec.substr(0, dash));
+            const std::string_view last_text = trim(spec.substr(dash + 1));
+
+            size_t first = 0;
+            size_t last = 0;
+            if (first_text.empty()) {
+                // 后缀范围：最后 N 个字节
+                size_t suffix_length = 0;
+                if (!parseNumber(last_text, suffix_length)) {
+                    return {};
+                }
+                if (suffix_length == 0 || size == 0) {
+                    continue;
+                }
+                first = suffix_length >= size ? 0 : size - suffix_length;
+                last = size - 1;
+            } else {
+                if (!parseNumber(first_text, first)) {
+                    return {};
+                }
+                if (last_text.empty()) {
+                    last = size - 1;  // "N-" 表示到资源末尾
+                } else if (!parseNumber(last_text, last) || last < first) {
+                    return {};
+                }
+                if (first >= size) {
+                    continue;
+                }
+                last = last < size ? last : size - 1;
+            }
+
+            result.ranges.push_back({first, last - first + 1});
+            total_length += last - first + 1;
+        }
+
+        if (spec_count == 0) {
+            return {};
+        }
+        if (result.ranges.empty()) {
+            result.status = Status::UNSATISFIABLE;
+            return result;
+        }
+        if (result.ranges.size() > 1 && total_length > size) {
+            // 大量重叠的范围会放大响应，直接返回完整资源
+            return {};
+        }
+
+        result.status = Status::SATISFIABLE;
+        return result;
+    }
+
+private:
+    [[nodiscard]] static bool parseNumber(const std::string_view text, size_t& number) {
+        if (text.empty()) {
+            return false;
+        }
+        const auto [ptr, error] = std::from_chars(text.data(), text.data() + text.size(), number);
+        return error == std::errc{} && ptr == text.data() + text.size();
+    }
+
+    [[nodiscard]] static std::string_view trim(std::string_view text) {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+            text.remove_prefix(1);
+        }
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+            text.remove_suffix(1);
+        }
+        return text;
+    }
+
+    [[nodiscard]] static bool equalsIgnoreCase(const std::string_view lhs, const std::string_view rhs) {
+        return std::ranges::equal(lhs, rhs, [](const char lhs_char, const char rhs_char) {
+            return std::tolower(static_cast<unsigned char>(lhs_char)) ==
+                   std::tolower(static_cast<unsigned char>(rhs_char));
+        });
+    }
+};
+
+#endif  // UTILS_RANGE_PARSER_H
@@ -0,0 +1,64 @@
+#ifndef UTILS_SOCKET_H
+#define UTILS_SOCKET_H
+
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+class Socket {
+public:
+    // 创建监听 socket：绑定端口并开始监听，reuse_port 为 true 时启用 SO_REUSEPORT 以便多个 socket 共享端口；
+    // address 为监听的 IPv4 地址（网络字节序），默认监听所有地址
+    [[nodiscard]] static int createListener(const uint16_t port, const bool reuse_port = false,
+                                            const in_addr_t address = INADDR_ANY) {
+        const int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (listen_fd == -1) {
+            throw std::runtime_error("Failed to create socket.");
+        }
+
+        // 配置服务器地址结构
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = address;
+
+        // 设置 socket 选项：快速重用地址
+        constexpr int opt = 1;
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        if (reuse_port && setsockopt(listen_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) == -1) {
+            close(listen_fd);
+            throw std::runtime_error(std::format("Failed to enable SO_REUSEPORT: {}", strerror(errno)));
+        }
+
+        // 绑定 socket 到地址
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1) {
+            close(listen_fd);
+            throw std::runtime_error("Failed to bind socket.");
+        }
+
+        // 开始监听连接请求
+        if (listen(listen_fd, SOMAXCONN) == -1) {
+            close(listen_fd);
+            throw std::runtime_error("Failed to listen on socket.");
+        }
+
+        // 设置监听 socket 为非阻塞
+        setNonBlocking(listen_fd);
+        return listen_fd;
+    }
+
+    // 设置为非阻塞模式
+    static int setNonBlocking(const int socket_fd) {
+        const int old_flags = fcntl(socket_fd, F_GETFL);           // NOLINT(cppcoreguidelines-pro-type-vararg)
+        return fcntl(socket_fd, F_SETFL, old_flags | O_NONBLOCK);  // NOLINT(cppcoreguidelines-pro-type-vararg)
+    }
+};
+
+#endif  // UTILS_SOCKET_H
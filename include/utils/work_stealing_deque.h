@@ -0,0 +1,129 @@
+#ifndef UTILS_WORK_STEALING_DEQUE_H
+#define UTILS_WORK_STEALING_DEQUE_H
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Chase-Lev 工作窃取双端队列（Lê 等人 2013 年给出的 C11 内存序版本）：
+// 所属线程在底部无锁地压入与弹出（LIFO，缓存友好），其他线程在顶部以 CAS 窃取（FIFO）。
+// 元素为指针，所有权随指针转移；数组写满时扩容为两倍，旧数组保留到队列析构，窃取者可能仍在读取
+template <typename T>
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(const size_t capacity = 256) {
+        auto array = std::make_unique<Array>(capacity);
+        array_.store(array.get(), std::memory_order_relaxed);
+        arrays_.push_back(std::move(array));
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+    WorkStealingDeque(WorkStealingDeque&&) = delete;
+    WorkStealingDeque& operator=(WorkStealingDeque&&) = delete;
+    ~WorkStealingDeque() = default;
+
+    // 压入底部（只能由所属线程调用）
+    void push(T* item) {
+        const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        const int64_t top = top_.load(std::memory_order_acquire);
+        Array* array = array_.load(std::memory_order_relaxed);
+        if (bottom - top > static_cast<int64_t>(array->capacity) - 1) {
+            array = grow(array, bottom, top);
+        }
+        array->put(bottom, item);
+        bottom_.store(bottom + 1, std::memory_order_release);  // 与 steal 对 bottom_ 的 acquire 读取配对，元素先于计数可见
+    }
+
+    // 从底部弹出（只能由所属线程调用），为空时返回 nullptr
+    T* pop() {
+        const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* array = array_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = top_.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        T* item = array->get(bottom);
+        if (top == bottom) {
+            // 只剩最后一个元素，与窃取者竞争
+            if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // 从顶部窃取（任意线程），为空或与其他线程竞争失败时返回 nullptr
+    T* steal() {
+        int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t bottom = bottom_.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return nullptr;
+        }
+
+        Array* array = array_.load(std::memory_order_acquire);
+        T* item = array->get(top);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    // 近似的元素个数（并发修改时只作参考）
+    [[nodiscard]] size_t size() const {
+        const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        const int64_t top = top_.load(std::memory_order_relaxed);
+        return bottom > top ? static_cast<size_t>(bottom - top) : 0;
+    }
+
+private:
+    // 环形数组，容量为 2 的幂
+    struct Array {
+        size_t capacity;
+        size_t mask;
+        std::unique_ptr<std::atomic<T*>[]> slots;
+
+        explicit Array(const size_t size)
+            : capacity(std::bit_ceil(size)), mask(capacity - 1), slots(new std::atomic<T*>[capacity]) {}
+
+        void put(const int64_t index, T* item) {
+            slots[static_cast<size_t>(index) & mask].store(item, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] T* get(const int64_t index) const {
+            return slots[static_cast<size_t>(index) & mask].load(std::memory_order_relaxed);
+        }
+    };
+
+    // 顶部与底部分处不同的缓存行，窃取者与所属线程互不干扰
+    // NOLINTNEXTLINE(readability-magic-numbers, cppcoreguidelines-avoid-magic-numbers)
+    alignas(64) std::atomic<int64_t> top_{0};
+    // NOLINTNEXTLINE(readability-magic-numbers, cppcoreguidelines-avoid-magic-numbers)
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    // NOLINTNEXTLINE(readability-magic-numbers, cppcoreguidelines-avoid-magic-numbers)
+    alignas(64) std::atomic<Array*> array_;
+    std::vector<std::unique_ptr<Array>> arrays_;  // 当前与已被替换的数组（只由所属线程修改）
+
+    Array* grow(const Array* old_array, const int64_t bottom, const int64_t top) {
+        auto array = std::make_unique<Array>(old_array->capacity * 2);
+        for (int64_t i = top; i < bottom; ++i) {
+            array->put(i, old_array->get(i));
+        }
+        Array* raw = array.get();
+        arrays_.push_back(std::move(array));
+        array_.store(raw, std::memory_order_release);
+        return raw;
+    }
+};
+
+#endif  // UTILS_WORK_STEALING_DEQUE_H
@@ -1,7 +1,17 @@
+#include <algorithm>
+#include <chrono>
+#include <csignal>
 #include <cstdint>
 #include <format>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
 
+#include "core/access_log.h"
+#include "core/connection.h"
+#include "core/metrics.h"
+#include "core/metrics_server.h"
 #include "core/server.h"
 #include "utils/config_parser.h"
 #include "utils/logger.h"
@@ -10,6 +20,10 @@
 #define STR(x) STR_HELPER(x)  // NOLINT(cppcoreguidelines-macro-usage)
 
 int main() {
+    // sendfile 无法指定 MSG_NOSIGNAL，对端中途重置连接时会触发 SIGPIPE；忽略后写入返回 EPIPE，由连接按正常关闭处理。
+    // 须在创建 Logger、Server 及任何线程之前设置
+    std::signal(SIGPIPE, SIG_IGN);
+
     try {
 #ifdef ROOT_PATH
         std::filesystem::path root_path = STR(ROOT_PATH);
@@ -19,24 +33,180 @@ int main() {
 
         const ConfigParser config(root_path / "config.ini");
 
-        Logger logger(config.getLogLevel());
+        // 异步模式下调用线程只写入自己的环形缓冲区，由后台线程批量写入文件
+        LoggerOptions log_options;
+        log_options.async = config.get("log_async", false);
+        log_options.buffer_bytes = config.get("log_buffer_size", 262144);
+        log_options.overflow = config.getLogOverflowPolicy();
+        log_options.sample_rate = config.get("log_sample_rate", 10);
+        log_options.flush_interval = std::chrono::milliseconds(config.get("log_flush_interval_ms", 100));
+        log_options.fsync_interval = std::chrono::milliseconds(config.get("log_fsync_interval_ms", 1000));
+
+        Logger logger(config.getLogLevel(), log_options);
         logger.logDivider("Config init");
+        if (config.getLogLevel() < LOG_COMPILE_MIN_LEVEL) {
+            logger.log(LogLevel::WARNING,
+                       std::format("Log level is below the compile-time level {}, lower records are compiled out.",
+                                   LOG_COMPILE_LEVEL));
+        }
+        if (log_options.async) {
+            logger.log(LogLevel::INFO,
+                       std::format("Async logging enabled: {} bytes per thread, overflow {}, flush every {}ms, "
+                                   "fsync every {}ms.",
+                                   log_options.buffer_bytes, config.get<std::string>("log_overflow", "drop"),
+                                   log_options.flush_interval.count(), log_options.fsync_interval.count()));
+        } else {
+            logger.log(LogLevel::INFO, "Async logging disabled (records are written synchronously).");
+        }
 
         const uint16_t port = config.get("port", 8080);
         logger.log(LogLevel::INFO, std::format("Server port: {}", port));
 
-        const size_t thread_count = config.get("thread_count", 4);
-        logger.log(LogLevel::INFO, std::format("Thread count: {}", thread_count));
+        // 线程数默认为 CPU 核数，运行中在 [min_threads, max_threads] 之间根据排队延迟与利用率自适应调整
+        const size_t cpu_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        ThreadPoolOptions pool_options;
+        pool_options.threads = config.get("thread_count", 0);
+        if (pool_options.threads == 0) {
+            pool_options.threads = cpu_count;
+        }
+        pool_options.min_threads = config.get("min_threads", 2);
+        pool_options.max_threads = config.get("max_threads", 0);
+        if (pool_options.max_threads == 0) {
+            pool_options.max_threads = cpu_count * 4;
+        }
+        pool_options.max_threads = std::max(pool_options.max_threads, pool_options.min_threads);
+        pool_options.threads = std::clamp(pool_options.threads, pool_options.min_threads, pool_options.max_threads);
+        pool_options.queue_capacity = config.get("task_queue_capacity", 1024);
+        logger.log(LogLevel::INFO, std::format("Thread count: {} (adaptive {}-{})", pool_options.threads,
+                                               pool_options.min_threads, pool_options.max_threads));
+        logger.log(LogLevel::INFO, std::format("Task queue capacity: {}", pool_options.queue_capacity));
 
-        const bool linger = config.get("linger", true);
-        if (linger) {
+        const size_t reactor_count = config.get("reactor_count", 0);
+        if (reactor_count > 0) {
+            logger.log(LogLevel::INFO, std::format("Reactor count: {}", reactor_count));
+        } else {
+            logger.log(LogLevel::INFO, "Reactor count: 0 (single epoll loop + thread pool)");
+        }
+
+        ConnectionOptions options;
+        options.linger = config.get("linger", true);
+        if (options.linger) {
             logger.log(LogLevel::INFO, "Linger mode enabled.");
         } else {
             logger.log(LogLevel::INFO, "Linger mode disabled.");
         }
 
+        options.keepalive_timeout = config.get("keepalive_timeout", 5);
+        options.keepalive_max_requests = config.get("keepalive_max_requests", 100);
+        if (options.keepalive_timeout > 0) {
+            logger.log(LogLevel::INFO, std::format("Keep-alive enabled: timeout {}s, max {} requests per connection.",
+                                                   options.keepalive_timeout, options.keepalive_max_requests));
+        } else {
+            logger.log(LogLevel::INFO, "Keep-alive disabled.");
+        }
+
+        options.max_header_bytes = config.get("max_header_bytes", 8192);
+        options.max_body_bytes = config.get("max_body_bytes", 1048576);
+        logger.log(LogLevel::INFO, std::format("Request limits: header {} bytes, body {} bytes.",
+                                               options.max_header_bytes, options.max_body_bytes));
+
+        StaticFileOptions static_options;
+        static_options.sendfile_threshold = config.get("sendfile_threshold", 65536);
+        if (static_options.sendfile_threshold > 0) {
+            logger.log(LogLevel::INFO, std::format("Sendfile enabled for files of {} bytes or larger.",
+                                                   static_options.sendfile_threshold));
+        } else {
+            logger.log(LogLevel::INFO, "Sendfile disabled.");
+        }
+
+        static_options.mmap_cache = config.get("mmap_cache", false);
+        if (static_options.mmap_cache) {
+            logger.log(LogLevel::INFO, "Cache mode: mmap (file contents shared with the page cache).");
+        } else {
+            logger.log(LogLevel::INFO, "Cache mode: heap.");
+        }
+
+        static_options.cache_max_bytes = config.get("cache_max_bytes", 67108864);
+        static_options.cache_max_entry_bytes = config.get("cache_max_entry_bytes", 1048576);
+        if (static_options.cache_max_bytes > 0) {
+            logger.log(LogLevel::INFO, std::format("Cache budget: {} bytes total, {} bytes per entry.",
+                                                   static_options.cache_max_bytes,
+                                                   static_options.cache_max_entry_bytes));
+        } else {
+            logger.log(LogLevel::INFO, "Cache disabled.");
+        }
+
+        static_options.watch_files = config.get("watch_files", true);
+        if (static_options.watch_files) {
+            logger.log(LogLevel::INFO, "File watching enabled (inotify invalidation).");
+        } else {
+            logger.log(LogLevel::INFO, "File watching disabled (mtime validation on every cache hit).");
+        }
+
+        static_options.fd_cache_size = config.get("fd_cache_size", 64);
+        if (static_options.watch_files && static_options.fd_cache_size > 0) {
+            logger.log(LogLevel::INFO, std::format("File descriptor cache: {} files.", static_options.fd_cache_size));
+        }
+
+        static_options.compression = config.get("compression", true);
+        if (static_options.compression) {
+            logger.log(LogLevel::INFO, "Compression enabled (gzip for text assets).");
+        } else {
+            logger.log(LogLevel::INFO, "Compression disabled.");
+        }
+
+        static_options.archive_path = config.get<std::string>("static_archive", "");
+        if (!static_options.archive_path.empty()) {
+            logger.log(LogLevel::INFO, std::format("Static archive: {}", static_options.archive_path));
+        }
+
+        // 访问日志：每个请求一条二进制定长记录，由 AccessLogDecode 离线解码
+        AccessLogOptions access_options;
+        access_options.path_prefix = config.get<std::string>("access_log", "");
+        access_options.max_file_bytes = config.get("access_log_max_bytes", 67108864);
+        std::unique_ptr<AccessLog> access_log;
+        if (!access_options.path_prefix.empty()) {
+            logger.log(LogLevel::INFO, std::format("Access log enabled: {}_*.bin, {} bytes per file.",
+                                                   access_options.path_prefix, access_options.max_file_bytes));
+            access_log = std::make_unique<AccessLog>(access_options, &logger);
+        } else {
+            logger.log(LogLevel::INFO, "Access log disabled.");
+        }
+
+        // 运行时指标：在指定路径以 Prometheus 文本格式提供；配置了指标端口时只在该端口提供，不出现在对外端口上
+        const auto metrics_path = config.get<std::string>("metrics_path", "");
+        MetricsServerOptions metrics_options;
+        metrics_options.address = config.get<std::string>("metrics_address", "127.0.0.1");
+        metrics_options.port = config.get("metrics_port", 0);
+        std::unique_ptr<Metrics> metrics;
+        if (metrics_path.starts_with('/')) {
+            metrics = std::make_unique<Metrics>(metrics_path);
+            options.serve_metrics = metrics_options.port == 0;
+            if (options.serve_metrics) {
+                logger.log(LogLevel::WARNING,
+                           std::format("Metrics enabled at {} on the public port {}; restrict access to it or set "
+                                       "metrics_port.",
+                                       metrics_path, port));
+            } else {
+                logger.log(LogLevel::INFO, std::format("Metrics enabled at {} on {}:{}", metrics_path,
+                                                       metrics_options.address, metrics_options.port));
+            }
+        } else if (!metrics_path.empty()) {
+            logger.log(LogLevel::WARNING,
+                       std::format("Invalid metrics_path '{}' (must start with '/'), metrics disabled.", metrics_path));
+        } else {
+            logger.log(LogLevel::INFO, "Metrics disabled.");
+        }
+
         logger.logDivider("Server init");
-        Server server(port, linger, &logger, thread_count);
+        Server server(port, options, static_options, pool_options, &logger, access_log.get(), metrics.get(),
+                      reactor_count);
+
+        // 指标端口在 Server 登记采集函数之后启动，并先于 Server 销毁
+        std::unique_ptr<MetricsServer> metrics_server;
+        if (metrics && !options.serve_metrics) {
+            metrics_server = std::make_unique<MetricsServer>(metrics_options, metrics.get(), &logger);
+        }
         server.run();
     } catch (const std::exception& e) {
         std::cerr << "Server crashed: " << e.what() << '\n';
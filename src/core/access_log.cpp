@@ -0,0 +1,280 @@
+#include "core/access_log.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <format>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "utils/access_log_format.h"
+#include "utils/logger.h"
+
+namespace {
+    constexpr size_t MIN_FILE_BYTES = 1048576;                                  // 单个文件的最小大小
+    constexpr size_t MAX_STRING_LENGTH = std::numeric_limits<uint16_t>::max();  // 字符串的最大长度，超出部分被截断
+    constexpr int64_t US_PER_SECOND = 1000000;
+
+    std::atomic<uint64_t> next_instance_id{1};
+
+    int64_t nowMicroseconds() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::system_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // 一条字符串记录占用的字节数
+    size_t stringRecordSize(const std::string_view value) {
+        return sizeof(AccessStringRecord) + AccessLogFormat::align(value.size());
+    }
+
+    // 单写者计数器加 1：只有所属线程写入，无需原子读改写指令
+    void increment(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    // 按创建时间生成文件名，sequence 大于 0 时附加序号（同一秒内多个线程创建文件、多次轮换或文件已存在）
+    std::string makeFilename(const std::string& prefix, const int64_t now_us, const size_t sequence) {
+        const std::time_t seconds = now_us / US_PER_SECOND;
+        std::tm local{};
+        localtime_r(&seconds, &local);
+        std::array<char, 32> stamp{};  // NOLINT(readability-magic-numbers, cppcoreguidelines-avoid-magic-numbers)
+        const std::string_view time(stamp.data(), std::strftime(stamp.data(), stamp.size(), "%Y%m%d-%H%M%S", &local));
+        if (sequence == 0) {
+            return std::format("{}_{}.bin", prefix, time);
+        }
+        return std::format("{}_{}_{}.bin", prefix, time, sequence);
+    }
+}  // namespace
+
+AccessLog::AccessLog(const AccessLogOptions& options, Logger* logger)
+    : options_(options), logger_(logger), instance_id_(next_instance_id.fetch_add(1, std::memory_order_relaxed)) {
+    options_.max_file_bytes = std::max(options_.max_file_bytes, MIN_FILE_BYTES);
+
+    // 启动时创建第一个写入器，前缀所在目录不可写时立即报错；它由第一个记录的线程接管
+    auto writer = std::make_shared<Writer>();
+    openFile(*writer, nowMicroseconds());
+    LOG(logger_, LogLevel::INFO, std::format("Access log started: {}", writer->filename));
+    writers_.push_back(std::move(writer));
+}
+
+AccessLog::~AccessLog() {
+    std::lock_guard lock(mutex_);
+    uint64_t records = 0;
+    uint64_t dropped = 0;
+    for (const auto& writer : writers_) {
+        closeFile(*writer);
+        records += writer->records.load(std::memory_order_relaxed);
+        dropped += writer->dropped.load(std::memory_order_relaxed);
+    }
+    LOG(logger_, LogLevel::INFO,
+        std::format("Access log closed: {} files, {} records written, {} dropped.", writers_.size(), records, dropped));
+}
+
+void AccessLog::record(const AccessEntry& entry) {
+    const std::string_view method = entry.method.substr(0, MAX_STRING_LENGTH);
+    const std::string_view target = entry.target.substr(0, MAX_STRING_LENGTH);
+
+    // 最坏情况下需要一条时间记录、两条字符串记录与一条请求记录，剩余空间不足时先轮换，保证一组记录位于同一文件
+    const size_t needed = sizeof(AccessTimeRecord) + stringRecordSize(method) + stringRecordSize(target) +
+                          sizeof(AccessRequestRecord);
+
+    // 写入器只属于本线程，以下的轮换、拷贝与日志输出都不持有任何锁
+    Writer& writer = threadWriter();
+    const int64_t now_us = nowMicroseconds();
+    if (writer.data != nullptr && writer.offset + needed > options_.max_file_bytes) {
+        closeFile(writer);
+        try {
+            openFile(writer, now_us);
+            LOG(logger_, LogLevel::INFO, std::format("Access log rotated: {}", writer.filename));
+        } catch (const std::runtime_error& e) {
+            LOG(logger_, LogLevel::ERROR, std::format("{} Access logging stopped for this writer.", e.what()));
+        }
+    }
+    if (writer.data == nullptr) {
+        increment(writer.dropped);
+        return;
+    }
+
+    // 时间倒退或间隔超出 32 位时写入新的时间基准
+    int64_t delta_us = now_us - writer.last_time_us;
+    if (delta_us < 0 || delta_us > std::numeric_limits<uint32_t>::max()) {
+        AccessTimeRecord time;
+        time.time_us = now_us;
+        append(writer, &time, sizeof(time));
+        delta_us = 0;
+    }
+    writer.last_time_us = now_us;
+
+    AccessRequestRecord request;
+    request.status = entry.status;
+    request.time_delta_us = static_cast<uint32_t>(delta_us);
+    request.client_ip = entry.client_ip;
+    request.client_port = entry.client_port;
+    request.method_id = intern(writer, method);
+    request.path_id = intern(writer, target);
+    request.latency_us = static_cast<uint32_t>(
+        std::clamp<int64_t>(entry.latency.count(), 0, std::numeric_limits<uint32_t>::max()));
+    request.bytes = entry.bytes;
+    append(writer, &request, sizeof(request));
+    increment(writer.records);
+}
+
+uint64_t AccessLog::recordCount() const {
+    std::lock_guard lock(mutex_);
+    uint64_t records = 0;
+    for (const auto& writer : writers_) {
+        records += writer->records.load(std::memory_order_relaxed);
+    }
+    return records;
+}
+
+uint64_t AccessLog::droppedCount() const {
+    std::lock_guard lock(mutex_);
+    uint64_t dropped = 0;
+    for (const auto& writer : writers_) {
+        dropped += writer->dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+AccessLog::Writer& AccessLog::threadWriter() {
+    // 线程缓存的写入器，线程退出时释放，由之后首次记录的线程接管
+    struct ThreadWriterHandle {
+        uint64_t log_id = 0;
+        std::shared_ptr<Writer> writer;
+
+        ThreadWriterHandle() = default;
+        ThreadWriterHandle(const ThreadWriterHandle&) = delete;
+        ThreadWriterHandle& operator=(const ThreadWriterHandle&) = delete;
+        ThreadWriterHandle(ThreadWriterHandle&&) = delete;
+        ThreadWriterHandle& operator=(ThreadWriterHandle&&) = delete;
+
+        ~ThreadWriterHandle() { release(); }
+
+        // 释放前的写入对接管的线程可见（release 与接管时的 acquire 配对）
+        void release() const {
+            if (writer) {
+                writer->in_use.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    thread_local ThreadWriterHandle handle;
+    if (handle.log_id == instance_id_) {
+        return *handle.writer;
+    }
+
+    // 首次在本实例中记录（或切换到了另一个实例）：接管一个空闲写入器
+    handle.release();
+    handle.writer.reset();
+    {
+        std::lock_guard lock(mutex_);
+        const auto iter = std::ranges::find_if(writers_, [](const std::shared_ptr<Writer>& writer) {
+            return !writer->in_use.load(std::memory_order_acquire);
+        });
+        if (iter != writers_.end()) {
+            handle.writer = *iter;
+            handle.writer->in_use.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    if (!handle.writer) {
+        // 没有空闲写入器：在锁外创建文件，之后只在登记时加锁；创建失败时该写入器的记录被丢弃
+        auto writer = std::make_shared<Writer>();
+        writer->in_use.store(true, std::memory_order_relaxed);
+        try {
+            openFile(*writer, nowMicroseconds());
+            LOG(logger_, LogLevel::INFO, std::format("Access log started: {}", writer->filename));
+        } catch (const std::runtime_error& e) {
+            LOG(logger_, LogLevel::ERROR, std::format("{} Access logging stopped for this writer.", e.what()));
+        }
+        std::lock_guard lock(mutex_);
+        handle.writer = writers_.emplace_back(std::move(writer));
+    }
+    handle.log_id = instance_id_;
+    return *handle.writer;
+}
+
+void AccessLog::openFile(Writer& writer, const int64_t now_us) const {
+    for (size_t sequence = 0;; ++sequence) {
+        std::string filename = makeFilename(options_.path_prefix, now_us, sequence);
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+        FileDescriptor file(open(filename.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644));
+        if (!file.valid()) {
+            if (errno == EEXIST) {
+                continue;
+            }
+            throw std::runtime_error(std::format("Failed to create access log {}: {}", filename, strerror(errno)));
+        }
+
+        // 预先分配磁盘空间：通过映射写入时不会因磁盘已满而收到 SIGBUS
+        if (const int error = posix_fallocate(file.get(), 0, static_cast<off_t>(options_.max_file_bytes)); error != 0) {
+            unlink(filename.c_str());
+            throw std::runtime_error(std::format("Failed to allocate access log {}: {}", filename, strerror(error)));
+        }
+
+        void* addr = mmap(nullptr, options_.max_file_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file.get(), 0);
+        if (addr == MAP_FAILED) {
+            unlink(filename.c_str());
+            throw std::runtime_error(std::format("Failed to mmap access log {}: {}", filename, strerror(errno)));
+        }
+
+        writer.file = std::move(file);
+        writer.filename = std::move(filename);
+        writer.data = static_cast<char*>(addr);
+        writer.offset = 0;
+        writer.last_time_us = now_us;
+        writer.strings.clear();
+
+        AccessLogHeader header;
+        header.magic = AccessLogFormat::MAGIC;
+        header.version = AccessLogFormat::VERSION;
+        header.base_time_us = now_us;
+        append(writer, &header, sizeof(header));
+        return;
+    }
+}
+
+void AccessLog::closeFile(Writer& writer) const {
+    if (writer.data == nullptr) {
+        return;
+    }
+
+    munmap(writer.data, options_.max_file_bytes);
+    writer.data = nullptr;
+
+    // 去掉预分配但未使用的空间
+    if (ftruncate(writer.file.get(), static_cast<off_t>(writer.offset)) == -1) {
+        LOG(logger_, LogLevel::WARNING,
+            std::format("Failed to truncate access log {}: {}", writer.filename, strerror(errno)));
+    }
+    writer.file = FileDescriptor();
+}
+
+uint32_t AccessLog::intern(Writer& writer, const std::string_view value) {
+    if (const auto it = writer.strings.find(value); it != writer.strings.end()) {
+        return it->second;
+    }
+
+    AccessStringRecord record;
+    record.length = static_cast<uint16_t>(value.size());
+    record.id = static_cast<uint32_t>(writer.strings.size());
+    append(writer, &record, sizeof(record));
+    append(writer, value.data(), value.size());
+    writer.strings.emplace(value, record.id);
+    return record.id;
+}
+
+void AccessLog::append(Writer& writer, const void* data, const size_t length) {
+    // 映射的空间预分配时已填零，补齐部分无需写入
+    std::memcpy(writer.data + writer.offset, data, length);
+    writer.offset += AccessLogFormat::align(length);
+}
@@ -1,32 +1,64 @@
 #include "core/connection.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <format>
 #include <string>
 #include <utility>
 
+#include <arpa/inet.h>
 #include <fcntl.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
+#include "core/access_log.h"
 #include "core/epoll_manager.h"
+#include "core/metrics.h"
 #include "core/static_file.h"
 #include "utils/form_parser.h"
 #include "utils/logger.h"
 
+namespace {
+    constexpr size_t READ_CHUNK_SIZE = 4096;  // 每次 read 至少预留的缓冲区空间
+
+    std::int64_t steadyNowMs(const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now()) {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+    }
+}  // namespace
+
 Connection::Connection(const int client_fd, const sockaddr_in& addr, EpollManager* epoll, Logger* logger,
-                       StaticFile* static_file, const bool linger)
-    : client_fd_(client_fd), info_(addr, client_fd), epoll_manager_(epoll), logger_(logger), static_file_(static_file) {
+                       StaticFile* static_file, AccessLog* access_log, Metrics* metrics,
+                       const ConnectionOptions& options)
+    : client_fd_(client_fd),
+      info_(addr, client_fd),
+      epoll_manager_(epoll),
+      logger_(logger),
+      static_file_(static_file),
+      access_log_(access_log),
+      metrics_(metrics),
+      options_(options),
+      peer_ip_(addr.sin_addr.s_addr),
+      peer_port_(ntohs(addr.sin_port)),
+      parser_(options.max_header_bytes, options.max_body_bytes) {
     // 设置 linger 选项
-    applyLinger(linger);
+    applyLinger(options_.linger);
+    touch();
 
-    // 将客户端 socket 添加到 epoll 中，监听读写事件
-    epoll_manager_->addFd(client_fd_, EPOLLIN);
+    // 将客户端 socket 添加到 epoll 中，监听读事件
+    epoll_manager_->addFd(client_fd_, options_.one_shot ? EPOLLIN | EPOLLONESHOT : EPOLLIN);
 
-    logger_->log(LogLevel::INFO, info_, "New client connected.");
+    if (metrics_ != nullptr) {
+        metrics_->connectionOpened();
+    }
+    LOG(logger_, LogLevel::INFO, info_, "New client connected.");
 }
 
 Connection::~Connection() {
     closeConnection();
+    if (metrics_ != nullptr) {
+        metrics_->connectionClosed();
+    }
 }
 
 int Connection::fd() const {
@@ -38,98 +70,231 @@ const Address& Connection::info() const {
 }
 
 void Connection::handle() {
+    std::lock_guard lock(handle_mutex_);
+    touch();
     readAndHandleRequest();
+
+    if (!closed_) {
+        updateEvents();
+    }
+}
+
+bool Connection::closeIfIdle(const std::chrono::steady_clock::time_point now) {
+    if (options_.keepalive_timeout <= 0) {
+        return false;
+    }
+
+    // 正在被其他线程处理的连接不视为空闲
+    const std::unique_lock lock(handle_mutex_, std::try_to_lock);
+    if (!lock.owns_lock() || closed_) {
+        return false;
+    }
+
+    constexpr std::int64_t ms_per_second = 1000;
+    if (steadyNowMs(now) - last_active_ms_ < options_.keepalive_timeout * ms_per_second) {
+        return false;
+    }
+
+    LOG(logger_, LogLevel::DEBUG, info_, "Keep-alive timeout, closing idle connection.");
+    closeConnection();
+    return true;
 }
 
 void Connection::readAndHandleRequest() {
     if (closed_) {
-        logger_->log(LogLevel::WARNING, info_, "Connection already closed.");
+        LOG(logger_, LogLevel::WARNING, info_, "Connection already closed.");
         return;
     }
 
-    constexpr std::size_t buffer_size = 4096;
-    std::array<char, buffer_size> buffer{};  // 用于存储从客户端接收到的数据
-    const ssize_t bytes_read = read(client_fd_, buffer.data(), buffer.size());
-
-    if (bytes_read == 0) {
-        // 如果读到 0 字节，说明客户端关闭连接
-        if (callback_) {
-            callback_(client_fd_);
-        }
+    // 先发送上次积压的数据，积压未清空前不再读取新请求（背压）
+    if (!output_buffer_.empty() && (!flushOutput() || !output_buffer_.empty())) {
         return;
     }
 
-    if (bytes_read < 0) {
-        if (errno == EAGAIN || errno == EWOULDBLOCK) {
-            return;  // 没有更多数据可读
-        }
-        if (errno == ECONNRESET) {
-            logger_->log(LogLevel::INFO, info_, "Connection reset by peer.");
-        } else {
-            logger_->log(LogLevel::ERROR, info_, std::format("Failed to read from client: {}", strerror(errno)));
+    if (!readFromClient()) {
+        return;
+    }
+    const bool recording = access_log_ != nullptr || metrics_ != nullptr;
+    const auto received = recording ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+
+    // 依次处理缓冲区中所有完整的请求（HTTP 流水线），响应按顺序进入输出队列后一次发送
+    size_t consumed = 0;
+    while (!close_after_write_ && consumed < input_buffer_.size()) {
+        const HttpParser::State state = parser_.parse(std::string_view(input_buffer_).substr(consumed));
+        const size_t first_segment = output_buffer_.segmentCount();
+        const size_t pending_bytes = output_buffer_.size();
+
+        if (state == HttpParser::State::ERROR) {
+            LOG(logger_, LogLevel::DEBUG, info_, std::format("Malformed request, return {}.", parser_.errorCode()));
+            output_buffer_.append(HttpResponse::buildErrorResponse(parser_.errorCode()));
+            recordRequest({}, {}, first_segment, output_buffer_.size() - pending_bytes, received);
+            close_after_write_ = true;
+            break;
         }
 
-        if (callback_) {
-            callback_(client_fd_);
+        if (state != HttpParser::State::COMPLETE) {
+            break;  // 剩余数据不足一个完整请求，保留解析进度等待后续数据
         }
-        return;
+
+        HttpRequest& request = parser_.request();
+        close_after_write_ = !handleRequest(request);
+        recordRequest(request.method, request.target, first_segment, output_buffer_.size() - pending_bytes, received);
+        consumed += parser_.requestSize();
+        parser_.reset();
     }
 
-    // 将读取的内容转换为 std::string 以便处理
-    const std::string request(buffer.data(), bytes_read);
-    std::string method;
-    std::string path;
+    // 丢弃已处理的数据，未完成的请求移动到缓冲区开头（解析器记录的是相对偏移）
+    input_buffer_.erase(0, consumed);
+
+    flushOutput();
+}
+
+bool Connection::readFromClient() {
+    // 单次最多缓冲一个最大请求的数据量，其余数据留在内核中等待下一次事件
+    const size_t read_limit = options_.max_header_bytes + options_.max_body_bytes;
+
+    // 直接读入连接的输入缓冲区，避免经过临时数组再拷贝
+    while (input_buffer_.size() < read_limit) {
+        const size_t old_size = input_buffer_.size();
+        const size_t writable = std::max(input_buffer_.capacity() - old_size, READ_CHUNK_SIZE);
+        input_buffer_.resize(old_size + writable);
+
+        const ssize_t bytes_read = read(client_fd_, input_buffer_.data() + old_size, writable);
+        input_buffer_.resize(old_size + static_cast<size_t>(std::max<ssize_t>(bytes_read, 0)));
+
+        if (bytes_read == 0) {
+            // 如果读到 0 字节，说明客户端关闭连接
+            requestClose();
+            return false;
+        }
 
-    // 提取 HTTP 请求方法和请求路径
-    if (const size_t method_end = request.find(' '); method_end != std::string::npos) {
-        method = request.substr(0, method_end);
+        if (bytes_read < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return true;  // 没有更多数据可读
+            }
+            if (errno == ECONNRESET) {
+                LOG(logger_, LogLevel::INFO, info_, "Connection reset by peer.");
+            } else {
+                LOG(logger_, LogLevel::ERROR, info_, std::format("Failed to read from client: {}", strerror(errno)));
+            }
+
+            requestClose();
+            return false;
+        }
 
-        const size_t path_start = method_end + 1;
-        if (const size_t path_end = request.find(' ', path_start); path_end != std::string::npos) {
-            path = request.substr(path_start, path_end - path_start);
+        if (static_cast<size_t>(bytes_read) < writable) {
+            return true;  // 内核缓冲区已读空
         }
     }
+    return true;
+}
 
-    std::string response;
+bool Connection::handleRequest(HttpRequest& request) {
+    request.keep_alive = shouldKeepAlive(request);
+    const std::string path(request.path());
 
     // 根据方法和路径进行不同的处理
-    if (method == "GET") {
-        logger_->log(LogLevel::DEBUG, info_, std::format("Handling GET for path: {}", path));
-        response = handleGetRequest(path);
-    } else if (method == "POST") {
-        logger_->log(LogLevel::DEBUG, info_, std::format("Handling POST for path: {}", path));
-
-        static constexpr std::string_view delimiter = "\r\n\r\n";
-        const size_t body_pos = request.find(delimiter);
-        if (body_pos == std::string::npos) {
-            constexpr int error_code = 400;
-            response = HttpResponse::buildErrorResponse(error_code);
-        } else {
-            std::string body = request.substr(body_pos + delimiter.size());
-            response = handlePostRequest(path, body);
-        }
+    if (metrics_ != nullptr && options_.serve_metrics && (request.method == "GET" || request.method == "HEAD") &&
+        path == metrics_->path()) {
+        LOG(logger_, LogLevel::DEBUG, info_, "Serving metrics.");
+        output_buffer_.append(HttpResponse{}
+                                  .setStatus("200 OK")
+                                  .setContentType(std::string(Metrics::CONTENT_TYPE))
+                                  .setBody(metrics_->render())
+                                  .setKeepAlive(request.keep_alive)
+                                  .setHeadOnly(request.method == "HEAD")
+                                  .build());
+    } else if (request.method == "GET" || request.method == "HEAD") {
+        LOG(logger_, LogLevel::DEBUG, info_, std::format("Handling {} for path: {}", request.method, path));
+        handleGetRequest(request);
+    } else if (request.method == "POST") {
+        LOG(logger_, LogLevel::DEBUG, info_, std::format("Handling POST for path: {}", path));
+        output_buffer_.append(handlePostRequest(path, std::string(request.body), request.keep_alive));
     } else {
-        logger_->log(LogLevel::DEBUG, info_, std::format("Unsupported method: {} on path: {}", method, path));
+        LOG(logger_, LogLevel::DEBUG, info_, std::format("Unsupported method: {} on path: {}", request.method, path));
         constexpr int error_code = 405;
-        response = HttpResponse::buildErrorResponse(error_code);
+        output_buffer_.append(HttpResponse::buildErrorResponse(error_code, "", request.keep_alive));
     }
 
-    write(client_fd_, response.c_str(), response.size());
+    ++requests_served_;
+    return request.keep_alive;
+}
 
-    if (callback_) {
-        callback_(client_fd_);
+void Connection::recordRequest(const std::string_view method, const std::string_view target, const size_t first_segment,
+                              const size_t bytes, const std::chrono::steady_clock::time_point received) const {
+    if (access_log_ == nullptr && metrics_ == nullptr) {
+        return;
+    }
+
+    // 处理请求期间不发送数据，新追加的第一个片段即响应的状态行与头部
+    const uint16_t status = HttpResponse::statusOf(output_buffer_.segmentData(first_segment));
+    const auto latency =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - received);
+
+    if (metrics_ != nullptr) {
+        metrics_->recordRequest(status, bytes, latency);
+    }
+    if (access_log_ != nullptr) {
+        access_log_->record({
+            .client_ip = peer_ip_,
+            .client_port = peer_port_,
+            .method = method,
+            .target = target,
+            .status = status,
+            .bytes = bytes,
+            .latency = latency,
+        });
+    }
+}
+
+bool Connection::flushOutput() {
+    switch (output_buffer_.flush(client_fd_)) {
+        case OutputBuffer::FlushResult::DONE:
+            if (close_after_write_) {
+                requestClose();
+                return false;
+            }
+            return true;
+        case OutputBuffer::FlushResult::AGAIN:
+            LOG(logger_, LogLevel::DEBUG, info_,
+                std::format("Socket send buffer full, {} bytes pending.", output_buffer_.size()));
+            return true;
+        default:
+            if (errno == EPIPE || errno == ECONNRESET) {
+                LOG(logger_, LogLevel::INFO, info_, "Connection reset by peer.");
+            } else {
+                LOG(logger_, LogLevel::ERROR, info_, std::format("Failed to write to client: {}", strerror(errno)));
+            }
+            requestClose();
+            return false;
+    }
+}
+
+void Connection::updateEvents() {
+    // 有积压数据时只关注可写事件，清空后再恢复读取
+    const uint32_t events = output_buffer_.empty() ? EPOLLIN : EPOLLOUT;
+
+    // EPOLLONESHOT 模式下每次处理完都需要重新注册
+    if (options_.one_shot) {
+        epoll_manager_->modFd(client_fd_, events | EPOLLONESHOT);
+    } else if (events != registered_events_) {
+        epoll_manager_->modFd(client_fd_, events);
     }
+    registered_events_ = events;
 }
 
-std::string Connection::handleGetRequest(const std::string& path) const {
-    return static_file_->serve(path, info_);
+void Connection::handleGetRequest(const HttpRequest& request) {
+    static_file_->serve(request, info_, output_buffer_);
 }
 
-std::string Connection::handlePostRequest(const std::string& path, const std::string& body) {
+std::string Connection::handlePostRequest(const std::string& path, const std::string& body, const bool keep_alive) {
     auto form_data = FormPasser::parse(body);
     if (form_data.empty()) {
         constexpr int error_code = 400;
-        return HttpResponse::buildErrorResponse(error_code, "No form data received.");
+        return HttpResponse::buildErrorResponse(error_code, "No form data received.", keep_alive);
     }
 
     std::string result = std::format("Received POST data from {}:\n", path);
@@ -137,7 +302,34 @@ std::string Connection::handlePostRequest(const std::string& path, const std::st
         result += std::format("    {} = {}\n", key, value);
     }
 
-    return HttpResponse{}.setStatus("200 OK").setContentType("text/plain; charset=UTF-8").setBody(result).build();
+    return HttpResponse{}
+        .setStatus("200 OK")
+        .setContentType("text/plain; charset=UTF-8")
+        .setBody(result)
+        .setKeepAlive(keep_alive)
+        .build();
+}
+
+bool Connection::shouldKeepAlive(const HttpRequest& request) const {
+    if (options_.keepalive_timeout <= 0) {
+        return false;
+    }
+    if (options_.keepalive_max_requests > 0 && requests_served_ + 1 >= options_.keepalive_max_requests) {
+        return false;
+    }
+    return request.keepAliveRequested();
+}
+
+void Connection::touch() {
+    last_active_ms_ = steadyNowMs();
+}
+
+void Connection::requestClose() {
+    // 先从连接表中移除，再关闭 fd，避免 fd 被新连接复用后误删
+    if (callback_) {
+        callback_(client_fd_);
+    }
+    closeConnection();
 }
 
 void Connection::closeConnection() {
@@ -149,7 +341,7 @@ void Connection::closeConnection() {
     epoll_manager_->delFd(client_fd_);
     close(client_fd_);
 
-    logger_->log(LogLevel::INFO, info_, "Client disconnected.");
+    LOG(logger_, LogLevel::INFO, info_, "Client disconnected.");
 }
 
 void Connection::applyLinger(const bool flag) const {
@@ -0,0 +1,79 @@
+#include "core/fd_cache.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+FdCache::FdCache(const size_t capacity) : capacity_(capacity) {}
+
+std::optional<CachedFile> FdCache::find(const std::filesystem::path& path) {
+    if (capacity_ == 0) {
+        return std::nullopt;
+    }
+
+    std::lock_guard lock(mutex_);
+    const auto index_iter = index_.find(path);
+    if (index_iter == index_.end()) {
+        return std::nullopt;
+    }
+    lru_.splice(lru_.begin(), lru_, index_iter->second);
+    return index_iter->second->second;
+}
+
+uint64_t FdCache::generation() const {
+    std::lock_guard lock(mutex_);
+    return generation_;
+}
+
+void FdCache::insert(const std::filesystem::path& path, CachedFile file, const uint64_t generation) {
+    if (capacity_ == 0) {
+        return;
+    }
+
+    std::lock_guard lock(mutex_);
+    if (generation_ != generation) {
+        return;  // 打开期间发生过失效，描述符可能指向已被替换的文件
+    }
+    if (const auto index_iter = index_.find(path); index_iter != index_.end()) {
+        lru_.erase(index_iter->second);
+        index_.erase(index_iter);
+    }
+    while (lru_.size() >= capacity_) {
+        index_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+
+    lru_.emplace_front(path, std::move(file));
+    index_.emplace(path, lru_.begin());
+}
+
+void FdCache::erase(const std::filesystem::path& path) {
+    std::lock_guard lock(mutex_);
+    ++generation_;
+    if (const auto index_iter = index_.find(path); index_iter != index_.end()) {
+        lru_.erase(index_iter->second);
+        index_.erase(index_iter);
+    }
+}
+
+void FdCache::eraseUnder(const std::filesystem::path& dir) {
+    const auto is_under = [&dir](const std::filesystem::path& path) {
+        return std::mismatch(dir.begin(), dir.end(), path.begin(), path.end()).first == dir.end();
+    };
+
+    std::lock_guard lock(mutex_);
+    ++generation_;
+    for (auto node = lru_.begin(); node != lru_.end();) {
+        if (is_under(node->first)) {
+            index_.erase(node->first);
+            node = lru_.erase(node);
+        } else {
+            node = std::next(node);
+        }
+    }
+}
+
+size_t FdCache::size() const {
+    std::lock_guard lock(mutex_);
+    return lru_.size();
+}
@@ -0,0 +1,189 @@
+#include "core/file_cache.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <initializer_list>
+#include <iterator>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <utility>
+
+#include "utils/mapped_file.h"
+
+namespace {
+    constexpr size_t MAX_SHARDS = 16;  // 最大分片数
+
+    // 分片数：在不超过 MAX_SHARDS 的前提下，保证每个分片至少能容纳一个最大条目
+    size_t shardCount(const size_t max_bytes, const size_t max_entry_bytes) {
+        if (max_entry_bytes == 0) {
+            return 1;  // 不限制单条大小时只能使用单个分片
+        }
+        return std::clamp<size_t>(max_bytes / max_entry_bytes, 1, MAX_SHARDS);
+    }
+}  // namespace
+
+std::string_view CacheEntry::headerValue(const std::string_view name) const {
+    const std::string_view head = std::string_view(*response).substr(0, header_size);
+
+    // 跳过状态行，逐行匹配 "name: value"
+    for (size_t line_start = head.find("\r\n"); line_start != std::string_view::npos;) {
+        line_start += 2;
+        const size_t line_end = head.find("\r\n", line_start);
+        const std::string_view line = head.substr(line_start, line_end - line_start);
+        if (line.size() > name.size() + 1 && line.starts_with(name) && line[name.size()] == ':') {
+            return line.substr(name.size() + 2);
+        }
+        line_start = line_end;
+    }
+    return {};
+}
+
+FileCache::FileCache(const size_t max_bytes, const size_t max_entry_bytes)
+    : max_entry_bytes_(max_entry_bytes),
+      shards_(shardCount(max_bytes, max_entry_bytes)),
+      shard_max_bytes_(max_bytes / shards_.size()) {}
+
+std::shared_ptr<const CacheEntry> FileCache::find(const std::filesystem::path& path,
+                                                  const std::optional<std::filesystem::file_time_type> last_modified) {
+    Shard& shard = shardFor(path);
+    {
+        // 命中路径只持有共享锁，访问位与计数均为原子操作
+        std::shared_lock lock(shard.mutex);
+        const auto index_iter = shard.index.find(path);
+        if (index_iter == shard.index.end()) {
+            shard.misses.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        const Node& node = *index_iter->second;
+        if (!last_modified || node.entry->last_modified == *last_modified) {
+            // 访问位已置位时不再写入，避免热点条目的缓存行在线程间来回迁移
+            if (!node.referenced.load(std::memory_order_relaxed)) {
+                node.referenced.store(true, std::memory_order_relaxed);
+            }
+            shard.hits.fetch_add(1, std::memory_order_relaxed);
+            return node.entry;
+        }
+    }
+
+    // 文件已被修改，缓存过期：换成独占锁后移除（期间可能已被其他线程替换，需要重新检查）
+    std::unique_lock lock(shard.mutex);
+    if (const auto index_iter = shard.index.find(path);
+        index_iter != shard.index.end() && index_iter->second->entry->last_modified != *last_modified) {
+        shard.removeNode(index_iter->second);
+    }
+    shard.misses.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+uint64_t FileCache::generation(const std::filesystem::path& path) {
+    return shardFor(path).generation.load(std::memory_order_acquire);
+}
+
+bool FileCache::insert(const std::filesystem::path& path, std::shared_ptr<const CacheEntry> entry,
+                       const uint64_t generation) {
+    const size_t charge = chargeOf(path, *entry);
+    if (shard_max_bytes_ == 0 || charge > shard_max_bytes_ || (max_entry_bytes_ > 0 && charge > max_entry_bytes_)) {
+        return false;
+    }
+
+    Shard& shard = shardFor(path);
+    std::unique_lock lock(shard.mutex);
+    if (shard.generation.load(std::memory_order_relaxed) != generation) {
+        return false;  // 读取文件期间发生过失效，内容可能已经过时
+    }
+    if (const auto index_iter = shard.index.find(path); index_iter != shard.index.end()) {
+        shard.removeNode(index_iter->second);
+    }
+    shard.evictFor(charge, shard_max_bytes_);
+
+    // 新条目插入到指针之前，等待指针转过一整圈后才会被考虑淘汰
+    const auto node = shard.clock.emplace(shard.hand, path, std::move(entry), charge);
+    shard.index.emplace(path, node);
+    shard.bytes += charge;
+    return true;
+}
+
+void FileCache::erase(const std::filesystem::path& path) {
+    Shard& shard = shardFor(path);
+    std::unique_lock lock(shard.mutex);
+    shard.generation.fetch_add(1, std::memory_order_release);
+    if (const auto index_iter = shard.index.find(path); index_iter != shard.index.end()) {
+        shard.removeNode(index_iter->second);
+    }
+}
+
+void FileCache::eraseUnder(const std::filesystem::path& dir) {
+    const auto is_under = [&dir](const std::filesystem::path& path) {
+        return std::mismatch(dir.begin(), dir.end(), path.begin(), path.end()).first == dir.end();
+    };
+
+    for (Shard& shard : shards_) {
+        std::unique_lock lock(shard.mutex);
+        shard.generation.fetch_add(1, std::memory_order_release);
+        for (auto node = shard.clock.begin(); node != shard.clock.end();) {
+            node = is_under(node->path) ? shard.removeNode(node) : std::next(node);
+        }
+    }
+}
+
+CacheStats FileCache::stats() const {
+    CacheStats stats;
+    for (const Shard& shard : shards_) {
+        std::shared_lock lock(shard.mutex);
+        stats.hits += shard.hits.load(std::memory_order_relaxed);
+        stats.misses += shard.misses.load(std::memory_order_relaxed);
+        stats.evictions += shard.evictions.load(std::memory_order_relaxed);
+        stats.entries += shard.index.size();
+        stats.bytes += shard.bytes;
+    }
+    return stats;
+}
+
+FileCache::Shard& FileCache::shardFor(const std::filesystem::path& path) {
+    return shards_.at(hash_value(path) % shards_.size());
+}
+
+size_t FileCache::chargeOf(const std::filesystem::path& path, const CacheEntry& entry) {
+    size_t charge = sizeof(Node) + sizeof(CacheEntry) + path.native().size();
+    if (entry.response) {
+        charge += entry.response->size();
+    }
+    if (entry.mapping) {
+        charge += entry.mapping->size();
+    }
+    for (const CacheEntry* variant : {entry.gzip.get(), entry.brotli.get()}) {
+        if (variant != nullptr) {
+            charge += sizeof(CacheEntry) + variant->response->size();
+        }
+    }
+    return charge;
+}
+
+FileCache::NodeList::iterator FileCache::Shard::removeNode(const NodeList::iterator node) {
+    if (node == hand) {
+        ++hand;
+    }
+    bytes -= node->charge;
+    index.erase(node->path);
+    return clock.erase(node);
+}
+
+void FileCache::Shard::evictFor(const size_t incoming, const size_t max_bytes) {
+    while (bytes + incoming > max_bytes && !clock.empty()) {
+        if (hand == clock.end()) {
+            hand = clock.begin();
+        }
+
+        if (hand->referenced.load(std::memory_order_relaxed)) {
+            // 最近被访问过：清除访问位，给予第二次机会
+            hand->referenced.store(false, std::memory_order_relaxed);
+            ++hand;
+            continue;
+        }
+
+        hand = removeNode(hand);
+        evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,125 @@
+#include "core/file_watcher.h"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <stdexcept>
+#include <utility>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace {
+    // 会导致缓存内容失效的事件：内容或属性被修改、目录项增删或移动、被监视目录自身被删除或移动
+    constexpr uint32_t WATCH_MASK = IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_DELETE | IN_MOVED_FROM |
+                                    IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+    constexpr size_t EVENT_BUFFER_SIZE = 16384;  // 单次读取事件的缓冲区大小
+}  // namespace
+
+FileWatcher::FileWatcher(const std::filesystem::path& root, Callback callback)
+    : inotify_fd_(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)), root_(root), callback_(std::move(callback)) {
+    if (inotify_fd_ == -1) {
+        throw std::runtime_error(std::format("Failed to create inotify instance: {}", strerror(errno)));
+    }
+
+    try {
+        addWatchRecursive(root_);
+    } catch (...) {
+        close(inotify_fd_);
+        throw;
+    }
+}
+
+FileWatcher::~FileWatcher() {
+    close(inotify_fd_);
+}
+
+int FileWatcher::getFd() const {
+    return inotify_fd_;
+}
+
+size_t FileWatcher::watchCount() const {
+    return watches_.size();
+}
+
+void FileWatcher::handleEvents() {
+    alignas(inotify_event) std::array<char, EVENT_BUFFER_SIZE> buffer{};
+
+    while (true) {
+        const ssize_t bytes_read = read(inotify_fd_, buffer.data(), buffer.size());
+        if (bytes_read == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return;  // 事件已读空
+            }
+            throw std::runtime_error(std::format("Failed to read inotify events: {}", strerror(errno)));
+        }
+
+        for (ssize_t offset = 0; offset < bytes_read;) {
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer.data() + offset);
+            handleEvent(*event);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+        }
+    }
+}
+
+void FileWatcher::addWatchRecursive(const std::filesystem::path& dir) {
+    addWatch(dir);
+
+    std::error_code error;
+    for (auto iter = std::filesystem::recursive_directory_iterator(
+             dir, std::filesystem::directory_options::skip_permission_denied, error);
+         !error && iter != std::filesystem::recursive_directory_iterator(); iter.increment(error)) {
+        if (iter->is_directory(error) && !iter->is_symlink(error)) {
+            addWatch(iter->path());
+        }
+    }
+}
+
+void FileWatcher::addWatch(const std::filesystem::path& dir) {
+    const int watch_fd = inotify_add_watch(inotify_fd_, dir.c_str(), WATCH_MASK);
+    if (watch_fd == -1) {
+        if (errno == ENOENT || errno == ENOTDIR) {
+            return;  // 目录在遍历过程中已被删除或替换
+        }
+        throw std::runtime_error(std::format("Failed to watch {}: {}", dir.string(), strerror(errno)));
+    }
+
+    // 同一目录被重复添加（如目录在树内移动）时内核返回相同的描述符，这里更新为新路径
+    watches_[watch_fd] = dir;
+}
+
+void FileWatcher::handleEvent(const inotify_event& event) {
+    if ((event.mask & IN_Q_OVERFLOW) != 0) {
+        // 事件队列溢出，部分变化已丢失，整棵树失效
+        callback_(root_, true);
+        return;
+    }
+
+    const auto watch_iter = watches_.find(event.wd);
+    if (watch_iter == watches_.end()) {
+        return;
+    }
+
+    if ((event.mask & IN_IGNORED) != 0) {
+        // 监视已被移除（目录被删除或所在文件系统被卸载）
+        watches_.erase(watch_iter);
+        return;
+    }
+
+    const std::filesystem::path path = event.len > 0 ? watch_iter->second / event.name : watch_iter->second;
+    const bool is_dir = (event.mask & IN_ISDIR) != 0 || (event.mask & (IN_DELETE_SELF | IN_MOVE_SELF)) != 0;
+
+    if (is_dir && (event.mask & (IN_CREATE | IN_MOVED_TO)) != 0) {
+        // 新出现的目录需要加入监视
+        addWatchRecursive(path);
+    }
+
+    callback_(path, is_dir);
+}
@@ -0,0 +1,211 @@
+#include "core/http_parser.h"
+
+#include <algorithm>
+#include <charconv>
+#include <string_view>
+
+namespace {
+    constexpr std::string_view CRLF = "\r\n";
+
+    // NOLINTBEGIN(readability-magic-numbers, cppcoreguidelines-avoid-magic-numbers)
+    constexpr int BAD_REQUEST = 400;
+    constexpr int PAYLOAD_TOO_LARGE = 413;
+    constexpr int URI_TOO_LONG = 414;
+    constexpr int HEADER_FIELDS_TOO_LARGE = 431;
+    constexpr int NOT_IMPLEMENTED = 501;
+    constexpr int VERSION_NOT_SUPPORTED = 505;
+    // NOLINTEND(readability-magic-numbers, cppcoreguidelines-avoid-magic-numbers)
+
+    bool isBlank(const char chr) {
+        return chr == ' ' || chr == '\t';
+    }
+}  // namespace
+
+HttpParser::HttpParser(const size_t max_header_bytes, const size_t max_body_bytes)
+    : max_header_bytes_(max_header_bytes), max_body_bytes_(max_body_bytes) {}
+
+HttpParser::State HttpParser::parse(const std::string_view data) {
+    State previous = state_;
+    do {
+        previous = state_;
+        switch (state_) {
+            case State::REQUEST_LINE:
+                state_ = parseRequestLine(data);
+                break;
+            case State::HEADERS:
+                state_ = parseHeaders(data);
+                break;
+            case State::BODY:
+                state_ = parseBody(data);
+                break;
+            default:
+                return state_;
+        }
+    } while (state_ != previous);
+
+    return state_;
+}
+
+HttpRequest& HttpParser::request() {
+    return request_;
+}
+
+size_t HttpParser::requestSize() const {
+    return body_start_ + content_length_;
+}
+
+int HttpParser::errorCode() const {
+    return error_code_;
+}
+
+void HttpParser::reset() {
+    state_ = State::REQUEST_LINE;
+    scan_pos_ = 0;
+    line_start_ = 0;
+    body_start_ = 0;
+    content_length_ = 0;
+    error_code_ = 0;
+    header_ranges_.clear();
+    request_.headers.clear();
+}
+
+HttpParser::State HttpParser::parseRequestLine(const std::string_view data) {
+    while (true) {
+        const size_t line_end = data.find(CRLF, std::max(scan_pos_, line_start_));
+        if (line_end == std::string_view::npos) {
+            if (data.size() - line_start_ > max_header_bytes_) {
+                return fail(URI_TOO_LONG);
+            }
+            // 末尾可能是半个 CRLF，下次从最后一个字节开始重新扫描
+            scan_pos_ = std::max(line_start_, data.empty() ? 0 : data.size() - 1);
+            return State::REQUEST_LINE;
+        }
+
+        // 忽略请求行之前的空行（RFC 9112 2.2）
+        if (line_end == line_start_) {
+            line_start_ = scan_pos_ = line_end + CRLF.size();
+            continue;
+        }
+
+        // 请求行格式：METHOD SP TARGET SP VERSION
+        const std::string_view line = data.substr(line_start_, line_end - line_start_);
+        const size_t method_end = line.find(' ');
+        const size_t target_end = method_end == std::string_view::npos ? method_end : line.find(' ', method_end + 1);
+        if (method_end == 0 || target_end == std::string_view::npos || target_end == method_end + 1) {
+            return fail(BAD_REQUEST);
+        }
+
+        const std::string_view version = line.substr(target_end + 1);
+        if (version != "HTTP/1.1" && version != "HTTP/1.0") {
+            return fail(version.starts_with("HTTP/") ? VERSION_NOT_SUPPORTED : BAD_REQUEST);
+        }
+
+        method_ = {.offset = line_start_, .length = method_end};
+        target_ = {.offset = line_start_ + method_end + 1, .length = target_end - method_end - 1};
+        version_ = {.offset = line_start_ + target_end + 1, .length = version.size()};
+
+        line_start_ = scan_pos_ = line_end + CRLF.size();
+        return State::HEADERS;
+    }
+}
+
+HttpParser::State HttpParser::parseHeaders(const std::string_view data) {
+    while (true) {
+        const size_t line_end = data.find(CRLF, std::max(scan_pos_, line_start_));
+        if (line_end == std::string_view::npos) {
+            if (data.size() > max_header_bytes_) {
+                return fail(HEADER_FIELDS_TOO_LARGE);
+            }
+            scan_pos_ = std::max(line_start_, data.size() - 1);
+            return State::HEADERS;
+        }
+
+        if (line_end + CRLF.size() > max_header_bytes_) {
+            return fail(HEADER_FIELDS_TOO_LARGE);
+        }
+
+        // 空行表示头部结束
+        if (line_end == line_start_) {
+            body_start_ = line_end + CRLF.size();
+            return finishHeaders(data);
+        }
+
+        // 头部格式：NAME ":" OWS VALUE OWS，不支持已废弃的多行折叠
+        const std::string_view line = data.substr(line_start_, line_end - line_start_);
+        const size_t colon = line.find(':');
+        if (colon == std::string_view::npos || colon == 0 || isBlank(line.front()) || isBlank(line[colon - 1])) {
+            return fail(BAD_REQUEST);
+        }
+
+        size_t value_begin = colon + 1;
+        size_t value_end = line.size();
+        while (value_begin < value_end && isBlank(line[value_begin])) {
+            ++value_begin;
+        }
+        while (value_end > value_begin && isBlank(line[value_end - 1])) {
+            --value_end;
+        }
+
+        header_ranges_.push_back({.name = {.offset = line_start_, .length = colon},
+                                  .value = {.offset = line_start_ + value_begin, .length = value_end - value_begin}});
+
+        line_start_ = scan_pos_ = line_end + CRLF.size();
+    }
+}
+
+HttpParser::State HttpParser::finishHeaders(const std::string_view data) {
+    bool has_length = false;
+    for (const auto& [name, value] : header_ranges_) {
+        const std::string_view header_name = data.substr(name.offset, name.length);
+        const std::string_view header_value = data.substr(value.offset, value.length);
+
+        if (HttpRequest::equalsIgnoreCase(header_name, "Transfer-Encoding")) {
+            // 暂不支持分块传输编码
+            return fail(NOT_IMPLEMENTED);
+        }
+
+        if (HttpRequest::equalsIgnoreCase(header_name, "Content-Length")) {
+            size_t length = 0;
+            const auto [end, error] =
+                std::from_chars(header_value.data(), header_value.data() + header_value.size(), length);
+            if (error != std::errc{} || end != header_value.data() + header_value.size() || header_value.empty() ||
+                (has_length && length != content_length_)) {
+                return fail(BAD_REQUEST);
+            }
+            content_length_ = length;
+            has_length = true;
+        }
+    }
+
+    if (content_length_ > max_body_bytes_) {
+        return fail(PAYLOAD_TOO_LARGE);
+    }
+
+    return parseBody(data);
+}
+
+HttpParser::State HttpParser::parseBody(const std::string_view data) {
+    if (data.size() - body_start_ < content_length_) {
+        return State::BODY;
+    }
+
+    // 请求完整，生成指向输入缓冲区的视图
+    request_.method = data.substr(method_.offset, method_.length);
+    request_.target = data.substr(target_.offset, target_.length);
+    request_.version = data.substr(version_.offset, version_.length);
+    request_.body = data.substr(body_start_, content_length_);
+    request_.keep_alive = false;
+
+    request_.headers.clear();
+    for (const auto& [name, value] : header_ranges_) {
+        request_.headers.push_back(
+            {.name = data.substr(name.offset, name.length), .value = data.substr(value.offset, value.length)});
+    }
+
+    return State::COMPLETE;
+}
+
+HttpParser::State HttpParser::fail(const int code) {
+    error_code_ = code;
+    return State::ERROR;
+}
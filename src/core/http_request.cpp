@@ -0,0 +1,67 @@
+#include "core/http_request.h"
+
+#include <algorithm>
+#include <cctype>
+#include <optional>
+#include <string_view>
+
+namespace {
+    std::string_view trim(std::string_view str) {
+        str.remove_prefix(std::min(str.find_first_not_of(" \t"), str.size()));
+        str.remove_suffix(str.size() - std::min(str.find_last_not_of(" \t") + 1, str.size()));
+        return str;
+    }
+}  // namespace
+
+std::optional<std::string_view> HttpRequest::header(const std::string_view name) const {
+    for (const auto& [header_name, header_value] : headers) {
+        if (equalsIgnoreCase(header_name, name)) {
+            return header_value;
+        }
+    }
+    return std::nullopt;
+}
+
+std::string_view HttpRequest::path() const {
+    return target.substr(0, target.find('?'));
+}
+
+std::string_view HttpRequest::query() const {
+    const size_t query_start = target.find('?');
+    return query_start == std::string_view::npos ? std::string_view{} : target.substr(query_start + 1);
+}
+
+bool HttpRequest::keepAliveRequested() const {
+    // HTTP/1.1 默认保持连接，HTTP/1.0 默认关闭
+    bool keep_alive = version == "HTTP/1.1";
+
+    if (const auto value = header("Connection")) {
+        if (containsToken(*value, "close")) {
+            keep_alive = false;
+        } else if (containsToken(*value, "keep-alive")) {
+            keep_alive = true;
+        }
+    }
+
+    return keep_alive;
+}
+
+bool HttpRequest::equalsIgnoreCase(const std::string_view lhs, const std::string_view rhs) {
+    return std::ranges::equal(lhs, rhs, [](const unsigned char lhs_char, const unsigned char rhs_char) {
+        return std::tolower(lhs_char) == std::tolower(rhs_char);
+    });
+}
+
+bool HttpRequest::containsToken(std::string_view value, const std::string_view token) {
+    while (!value.empty()) {
+        const size_t comma = value.find(',');
+        if (equalsIgnoreCase(trim(value.substr(0, comma)), token)) {
+            return true;
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        value.remove_prefix(comma + 1);
+    }
+    return false;
+}
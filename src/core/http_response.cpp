@@ -1,11 +1,17 @@
 #include "core/http_response.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <format>
 #include <map>
 #include <sstream>
 #include <string>
+#include <string_view>
 
 namespace {
+    constexpr std::string_view CONNECTION_KEEP_ALIVE = "Connection: keep-alive\r\n\r\n";
+    constexpr std::string_view CONNECTION_CLOSE = "Connection: close\r\n\r\n";
+
     constexpr auto ERROR_HTML_TEMPLATE = R"(
 <!DOCTYPE html>
 <html lang="en">
@@ -48,21 +54,45 @@ HttpResponse& HttpResponse::addHeader(const std::string& key, const std::string&
     return *this;
 }
 
+HttpResponse& HttpResponse::setKeepAlive(const bool keep_alive) {
+    keep_alive_ = keep_alive;
+    return *this;
+}
+
+HttpResponse& HttpResponse::setHeadOnly(const bool head_only) {
+    head_only_ = head_only;
+    return *this;
+}
+
 std::string HttpResponse::build() {
+    if (head_only_) {
+        return buildHeader(body_.size());
+    }
+    return buildHeader(body_.size()) + body_;
+}
+
+std::string HttpResponse::buildHeader(const size_t content_length) {
+    return buildHeaderFields(content_length) + std::string(connectionLine(keep_alive_));
+}
+
+std::string HttpResponse::buildHeaderFields(const size_t content_length) {
     std::ostringstream oss;
     oss << "HTTP/1.1 " << status_ << "\r\n";
-    headers_["Content-Length"] = std::to_string(body_.size());
-    headers_["Connection"] = "close";
+    headers_["Content-Length"] = std::to_string(content_length);
 
     for (const auto& [key, value] : headers_) {
         oss << key << ": " << value << "\r\n";
     }
 
-    oss << "\r\n" << body_;
     return oss.str();
 }
 
-std::string HttpResponse::buildErrorResponse(const int code, const std::string& tips) {
+std::string_view HttpResponse::connectionLine(const bool keep_alive) {
+    return keep_alive ? CONNECTION_KEEP_ALIVE : CONNECTION_CLOSE;
+}
+
+std::string HttpResponse::buildErrorResponse(const int code, const std::string& tips, const bool keep_alive,
+                                             const bool head_only) {
     std::string status;
     std::string message;
 
@@ -84,14 +114,34 @@ std::string HttpResponse::buildErrorResponse(const int code, const std::string&
             status = "Method Not Allowed";
             message = "The method you're trying to use is not allowed for this resource.";
             break;
+        case 413:
+            status = "Payload Too Large";
+            message = "The request body is larger than the server is willing to process.";
+            break;
+        case 414:
+            status = "URI Too Long";
+            message = "The request target is longer than the server is willing to interpret.";
+            break;
+        case 431:
+            status = "Request Header Fields Too Large";
+            message = "The request headers are larger than the server is willing to process.";
+            break;
         case 500:
             status = "Internal Server Error";
             message = "Something went wrong on the server.";
             break;
+        case 501:
+            status = "Not Implemented";
+            message = "The server does not support the functionality required to fulfill the request.";
+            break;
         case 502:
             status = "Bad Gateway";
             message = "The server received an invalid response from an upstream server.";
             break;
+        case 505:
+            status = "HTTP Version Not Supported";
+            message = "The server only supports HTTP/1.0 and HTTP/1.1.";
+            break;
         default:
             status = "Unknown Error";
             message = std::to_string(code) + " Unknown Error";
@@ -107,5 +157,26 @@ std::string HttpResponse::buildErrorResponse(const int code, const std::string&
         .setStatus(std::format("{} {}", code, status))
         .setContentType("text/html; charset=UTF-8")
         .setBody(std::format(ERROR_HTML_TEMPLATE, code, status, message))
+        .setKeepAlive(keep_alive)
+        .setHeadOnly(head_only)
         .build();
 }
+
+uint16_t HttpResponse::statusOf(const std::string_view response) {
+    // 状态行：HTTP/1.1 200 OK
+    constexpr size_t status_offset = 9;
+    constexpr size_t status_digits = 3;
+    if (!response.starts_with("HTTP/") || response.size() < status_offset + status_digits) {
+        return 0;
+    }
+
+    uint16_t status = 0;
+    for (const char digit : response.substr(status_offset, status_digits)) {
+        if (digit < '0' || digit > '9') {
+            return 0;
+        }
+        constexpr uint16_t base = 10;
+        status = static_cast<uint16_t>(status * base + (digit - '0'));
+    }
+    return status;
+}
@@ -0,0 +1,168 @@
+#include "core/metrics.h"
+
+#include <algorithm>
+#include <format>
+#include <utility>
+
+namespace {
+    constexpr size_t HISTOGRAM_MAX_EXPONENT = 25;                         // 输出的最大桶边界为 2^25 微秒（约 33.5 秒）
+    constexpr std::array<double, 4> QUANTILES = {0.5, 0.9, 0.99, 0.999};  // 输出的分位数
+    constexpr double US_PER_SECOND = 1e6;
+
+    std::atomic<uint64_t> next_instance_id{1};
+
+    // 单写者计数器加 value：只有所属线程写入，无需原子读改写指令
+    void add(std::atomic<uint64_t>& counter, const uint64_t value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    double toSeconds(const uint64_t microseconds) {
+        return static_cast<double>(microseconds) / US_PER_SECOND;
+    }
+
+    void writeHeader(std::string& out, const std::string_view name, const std::string_view help,
+                     const std::string_view type) {
+        out += std::format("# HELP {} {}\n# TYPE {} {}\n", name, help, name, type);
+    }
+}  // namespace
+
+Metrics::Metrics(std::string path)
+    : path_(std::move(path)),
+      instance_id_(next_instance_id.fetch_add(1, std::memory_order_relaxed)),
+      start_time_(std::chrono::system_clock::now()) {}
+
+void Metrics::recordRequest(const uint16_t status, const uint64_t bytes, const std::chrono::microseconds latency) {
+    Shard& shard = threadShard();
+    add(shard.requests.at(status < STATUS_CODE_LIMIT ? status : 0), 1);
+    add(shard.response_bytes, bytes);
+    shard.latency.record(static_cast<uint64_t>(std::max<int64_t>(latency.count(), 0)));
+}
+
+void Metrics::connectionOpened() {
+    add(threadShard().connections_opened, 1);
+}
+
+void Metrics::connectionClosed() {
+    add(threadShard().connections_closed, 1);
+}
+
+void Metrics::addCollector(Collector collector) {
+    std::lock_guard lock(mutex_);
+    collectors_.push_back(std::move(collector));
+}
+
+std::string Metrics::render() const {
+    std::array<uint64_t, STATUS_CODE_LIMIT> requests{};
+    uint64_t response_bytes = 0;
+    uint64_t connections_opened = 0;
+    uint64_t connections_closed = 0;
+    LatencySnapshot latency;
+
+    std::lock_guard lock(mutex_);
+    for (const auto& shard : shards_) {
+        for (size_t code = 0; code < STATUS_CODE_LIMIT; ++code) {
+            requests.at(code) += shard->requests.at(code).load(std::memory_order_relaxed);
+        }
+        response_bytes += shard->response_bytes.load(std::memory_order_relaxed);
+        connections_opened += shard->connections_opened.load(std::memory_order_relaxed);
+        connections_closed += shard->connections_closed.load(std::memory_order_relaxed);
+        shard->latency.mergeInto(latency);
+    }
+
+    std::string out;
+    writeHeader(out, "webserver_http_requests_total", "HTTP requests handled, by response status code.", "counter");
+    for (size_t code = 0; code < STATUS_CODE_LIMIT; ++code) {
+        if (requests.at(code) > 0) {
+            out += std::format("webserver_http_requests_total{{code=\"{}\"}} {}\n", code, requests.at(code));
+        }
+    }
+    writeCounter(out, "webserver_http_response_bytes_total", "Bytes of HTTP responses (headers and body).",
+                 response_bytes);
+
+    // 直方图只输出 2 的幂微秒的桶边界（恰好是内部分桶的边界），内部的细分桶用于计算分位数。
+    // 记录的耗时已截断到微秒，小于 2^k 微秒的记录即真实耗时不超过 2^k 微秒的请求
+    writeHeader(out, "webserver_http_request_duration_seconds",
+                "Time from reading an HTTP request to queuing its response.", "histogram");
+    for (size_t exponent = 0; exponent <= HISTOGRAM_MAX_EXPONENT; ++exponent) {
+        const uint64_t bound = uint64_t{1} << exponent;
+        out += std::format("webserver_http_request_duration_seconds_bucket{{le=\"{}\"}} {}\n", toSeconds(bound),
+                           latency.countBelow(bound));
+    }
+    out += std::format("webserver_http_request_duration_seconds_bucket{{le=\"+Inf\"}} {}\n", latency.count);
+    out += std::format("webserver_http_request_duration_seconds_sum {}\n", toSeconds(latency.sum));
+    out += std::format("webserver_http_request_duration_seconds_count {}\n", latency.count);
+
+    writeHeader(out, "webserver_http_request_duration_quantile_seconds",
+                "Request duration quantiles since start (upper bound of the 12.5% wide bucket).", "gauge");
+    for (const double quantile : QUANTILES) {
+        out += std::format("webserver_http_request_duration_quantile_seconds{{quantile=\"{}\"}} {}\n", quantile,
+                           toSeconds(latency.quantile(quantile)));
+    }
+
+    // 连接的建立与关闭可能由不同线程记录，合并时两者不是同一时刻的值
+    writeCounter(out, "webserver_connections_accepted_total", "Client connections accepted.", connections_opened);
+    writeGauge(out, "webserver_connections_open", "Client connections currently open.",
+               static_cast<double>(connections_opened - std::min(connections_closed, connections_opened)));
+    writeGauge(out, "webserver_start_time_seconds", "Unix time the server started.",
+               std::chrono::duration<double>(start_time_.time_since_epoch()).count());
+
+    for (const Collector& collector : collectors_) {
+        collector(out);
+    }
+    return out;
+}
+
+void Metrics::writeCounter(std::string& out, const std::string_view name, const std::string_view help,
+                           const uint64_t value) {
+    writeHeader(out, name, help, "counter");
+    out += std::format("{} {}\n", name, value);
+}
+
+void Metrics::writeCounter(std::string& out, const std::string_view name, const std::string_view help,
+                           const double value) {
+    writeHeader(out, name, help, "counter");
+    out += std::format("{} {}\n", name, value);
+}
+
+void Metrics::writeGauge(std::string& out, const std::string_view name, const std::string_view help,
+                         const double value) {
+    writeHeader(out, name, help, "gauge");
+    out += std::format("{} {}\n", name, value);
+}
+
+Metrics::Shard& Metrics::threadShard() {
+    // 线程缓存的分片，线程退出时释放，由之后首次记录的线程接管
+    struct ThreadShardHandle {
+        uint64_t metrics_id = 0;
+        std::shared_ptr<Shard> shard;
+
+        ThreadShardHandle() = default;
+        ThreadShardHandle(const ThreadShardHandle&) = delete;
+        ThreadShardHandle& operator=(const ThreadShardHandle&) = delete;
+        ThreadShardHandle(ThreadShardHandle&&) = delete;
+        ThreadShardHandle& operator=(ThreadShardHandle&&) = delete;
+
+        ~ThreadShardHandle() { release(); }
+
+        // 释放前的写入对接管的线程可见（release 与接管时的 acquire 配对）
+        void release() const {
+            if (shard) {
+                shard->in_use.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    thread_local ThreadShardHandle handle;
+    if (handle.metrics_id != instance_id_) {
+        // 首次在本实例中记录（或切换到了另一个实例）：接管一个空闲分片，没有时新建
+        handle.release();
+        std::lock_guard lock(mutex_);
+        const auto iter = std::ranges::find_if(shards_, [](const std::shared_ptr<Shard>& shard) {
+            return !shard->in_use.load(std::memory_order_acquire);
+        });
+        handle.shard = iter != shards_.end() ? *iter : shards_.emplace_back(std::make_shared<Shard>());
+        handle.shard->in_use.store(true, std::memory_order_relaxed);
+        handle.metrics_id = instance_id_;
+    }
+    return *handle.shard;
+}
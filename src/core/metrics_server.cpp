@@ -0,0 +1,168 @@
+#include "core/metrics_server.h"
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "core/http_parser.h"
+#include "core/http_request.h"
+#include "core/http_response.h"
+#include "core/metrics.h"
+#include "utils/file_descriptor.h"
+#include "utils/logger.h"
+#include "utils/socket.h"
+
+namespace {
+    constexpr size_t MAX_HEADER_BYTES = 8192;                     // 请求行 + 头部允许的最大字节数
+    constexpr size_t READ_CHUNK_BYTES = 4096;                     // 单次读取的字节数
+    constexpr std::chrono::milliseconds CLIENT_TIMEOUT{2000};     // 读取整个请求的时限
+    constexpr timeval SEND_TIMEOUT{.tv_sec = 2, .tv_usec = 0};    // 单次发送的超时
+    constexpr std::chrono::milliseconds ACCEPT_RETRY_DELAY{100};  // 描述符耗尽时重试 accept 的间隔
+
+    // 写出全部数据，超时或出错时返回 false
+    bool sendAll(const int client_fd, std::string_view data) {
+        while (!data.empty()) {
+            const ssize_t sent = send(client_fd, data.data(), data.size(), MSG_NOSIGNAL);
+            if (sent == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            data.remove_prefix(static_cast<size_t>(sent));
+        }
+        return true;
+    }
+}  // namespace
+
+MetricsServer::MetricsServer(const MetricsServerOptions& options, Metrics* metrics, Logger* logger)
+    : options_(options), metrics_(metrics), logger_(logger) {
+    in_addr address{};
+    if (inet_pton(AF_INET, options_.address.c_str(), &address) != 1) {
+        throw std::runtime_error(std::format("Invalid metrics address: {}", options_.address));
+    }
+
+    try {
+        listen_fd_ = Socket::createListener(options_.port, false, address.s_addr);
+    } catch (const std::exception& e) {
+        LOG(logger_, LogLevel::ERROR,
+            std::format("Metrics listener setup failed on {}:{}: {}", options_.address, options_.port, e.what()));
+        throw;
+    }
+
+    LOG(logger_, LogLevel::INFO,
+        std::format("Metrics listening on {}:{} at {}", options_.address, options_.port, metrics_->path()));
+    thread_ = std::thread([this] { loop(); });
+}
+
+MetricsServer::~MetricsServer() {
+    // 关闭监听 socket 的读写会唤醒阻塞在 poll 上的处理线程
+    stop_.store(true);
+    shutdown(listen_fd_, SHUT_RDWR);
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    close(listen_fd_);
+}
+
+void MetricsServer::loop() {
+    pollfd listener{.fd = listen_fd_, .events = POLLIN, .revents = 0};
+    while (!stop_.load()) {
+        if (poll(&listener, 1, -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG(logger_, LogLevel::ERROR, std::format("Metrics listener poll failed: {}", strerror(errno)));
+            return;
+        }
+
+        // 接受的连接为阻塞模式，由读写超时限制处理时间
+        const int client_fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client_fd == -1) {
+            if (errno == EMFILE || errno == ENFILE) {
+                LOG(logger_, LogLevel::WARNING, "Metrics listener is out of file descriptors.");
+                std::this_thread::sleep_for(ACCEPT_RETRY_DELAY);
+            }
+            continue;  // 其他错误：连接已被对端取消，或监听 socket 已关闭
+        }
+        handleClient(client_fd);
+    }
+}
+
+void MetricsServer::handleClient(const int client_fd) const {
+    const FileDescriptor client(client_fd);
+    setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &SEND_TIMEOUT, sizeof(SEND_TIMEOUT));
+
+    // 整个请求共用一个截止时间，每次读取前按剩余时间 poll：逐字节慢速发送的客户端也只能占用处理线程 CLIENT_TIMEOUT。
+    // 指标请求没有正文，每个连接只处理一个请求
+    const auto deadline = std::chrono::steady_clock::now() + CLIENT_TIMEOUT;
+    HttpParser parser(MAX_HEADER_BYTES, 0);
+    HttpParser::State state = HttpParser::State::REQUEST_LINE;
+    std::string buffer;
+    std::array<char, READ_CHUNK_BYTES> chunk{};
+    while (state != HttpParser::State::COMPLETE && state != HttpParser::State::ERROR) {
+        const auto remaining =
+            std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0) {
+            LOG(logger_, LogLevel::DEBUG, "Metrics request timed out, closing connection.");
+            return;
+        }
+        pollfd readable{.fd = client_fd, .events = POLLIN, .revents = 0};
+        const int ready = poll(&readable, 1, static_cast<int>(remaining.count()));
+        if (ready == -1 && errno != EINTR) {
+            return;
+        }
+        if (ready <= 0) {
+            continue;  // 被信号中断，或已到截止时间（下一轮关闭连接）
+        }
+
+        const ssize_t bytes_read = recv(client_fd, chunk.data(), chunk.size(), MSG_DONTWAIT);
+        if (bytes_read == -1 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) {
+            continue;
+        }
+        if (bytes_read <= 0) {
+            return;  // 对端关闭或读取出错
+        }
+        buffer.append(chunk.data(), static_cast<size_t>(bytes_read));
+        state = parser.parse(buffer);
+    }
+
+    std::string response;
+    if (state == HttpParser::State::ERROR) {
+        response = HttpResponse::buildErrorResponse(parser.errorCode());
+    } else {
+        const HttpRequest& request = parser.request();
+        const bool head_only = request.method == "HEAD";
+        if (request.path() != metrics_->path()) {
+            constexpr int error_code = 404;
+            response = HttpResponse::buildErrorResponse(error_code, "", false, head_only);
+        } else if (request.method != "GET" && !head_only) {
+            constexpr int error_code = 405;
+            response = HttpResponse::buildErrorResponse(error_code);
+        } else {
+            response = HttpResponse{}
+                           .setStatus("200 OK")
+                           .setContentType(std::string(Metrics::CONTENT_TYPE))
+                           .setBody(metrics_->render())
+                           .setHeadOnly(head_only)
+                           .build();
+        }
+    }
+
+    if (!sendAll(client_fd, response)) {
+        LOG(logger_, LogLevel::DEBUG, std::format("Metrics response not fully sent: {}", strerror(errno)));
+    }
+}
@@ -0,0 +1,137 @@
+#include "core/output_buffer.h"
+
+#include <array>
+#include <cerrno>
+#include <utility>
+
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace {
+    constexpr size_t MAX_IOVECS = 64;  // 单次 writev 携带的最大片段数
+}  // namespace
+
+void OutputBuffer::append(std::string data) {
+    if (data.empty()) {
+        return;
+    }
+    pending_bytes_ += data.size();
+    segments_.push_back({.owned = std::move(data)});
+}
+
+void OutputBuffer::append(const std::string_view data, std::shared_ptr<const void> owner) {
+    if (data.empty()) {
+        return;
+    }
+    pending_bytes_ += data.size();
+    segments_.push_back({.view = data, .owner = std::move(owner)});
+}
+
+void OutputBuffer::appendFile(const int file_fd, const off_t offset, const size_t length,
+                              std::shared_ptr<const void> owner) {
+    if (length == 0) {
+        return;
+    }
+    pending_bytes_ += length;
+    segments_.push_back({.owner = std::move(owner), .file_fd = file_fd, .file_offset = offset, .file_length = length});
+}
+
+bool OutputBuffer::empty() const {
+    return pending_bytes_ == 0;
+}
+
+size_t OutputBuffer::size() const {
+    return pending_bytes_;
+}
+
+size_t OutputBuffer::segmentCount() const {
+    return segments_.size();
+}
+
+std::string_view OutputBuffer::segmentData(const size_t index) const {
+    if (index >= segments_.size() || segments_[index].isFile()) {
+        return {};
+    }
+    return segments_[index].data();
+}
+
+OutputBuffer::FlushResult OutputBuffer::flush(const int socket_fd) {
+    while (!segments_.empty()) {
+        const ssize_t bytes_sent = segments_.front().isFile() ? sendFile(socket_fd) : sendMemory(socket_fd);
+        if (bytes_sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return FlushResult::AGAIN;
+            }
+            return FlushResult::ERROR;
+        }
+        if (bytes_sent == 0) {
+            // 文件在发送过程中被截断，无法再补齐 Content-Length
+            errno = EIO;
+            return FlushResult::ERROR;
+        }
+
+        consume(static_cast<size_t>(bytes_sent));
+    }
+
+    return FlushResult::DONE;
+}
+
+void OutputBuffer::clear() {
+    segments_.clear();
+    front_offset_ = 0;
+    pending_bytes_ = 0;
+}
+
+ssize_t OutputBuffer::sendMemory(const int socket_fd) {
+    std::array<iovec, MAX_IOVECS> iovecs{};
+
+    // 组装 iovec，队首片段跳过已发送的部分，遇到文件片段为止
+    size_t iov_count = 0;
+    bool followed_by_file = false;
+    for (auto iter = segments_.begin(); iter != segments_.end() && iov_count < iovecs.size(); ++iter) {
+        if (iter->isFile()) {
+            followed_by_file = true;
+            break;
+        }
+        std::string_view data = iter->data();
+        if (iov_count == 0) {
+            data.remove_prefix(front_offset_);
+        }
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+        iovecs.at(iov_count).iov_base = const_cast<char*>(data.data());
+        iovecs.at(iov_count).iov_len = data.size();
+        ++iov_count;
+    }
+
+    // 使用 sendmsg 代替 writev 以便指定 MSG_NOSIGNAL，避免对端关闭时触发 SIGPIPE；
+    // 后面紧跟文件内容时附加 MSG_MORE，让响应头与文件开头合并到同一个报文
+    msghdr message{};
+    message.msg_iov = iovecs.data();
+    message.msg_iovlen = iov_count;
+    return sendmsg(socket_fd, &message, MSG_NOSIGNAL | (followed_by_file ? MSG_MORE : 0));
+}
+
+ssize_t OutputBuffer::sendFile(const int socket_fd) {
+    const Segment& segment = segments_.front();
+    off_t offset = segment.file_offset + static_cast<off_t>(front_offset_);
+    // sendfile 不接受 MSG_NOSIGNAL，对端关闭时的 SIGPIPE 由 main 在启动时忽略，这里只返回 EPIPE
+    return sendfile(socket_fd, segment.file_fd, &offset, segment.file_length - front_offset_);
+}
+
+void OutputBuffer::consume(size_t bytes) {
+    pending_bytes_ -= bytes;
+    while (bytes > 0 && !segments_.empty()) {
+        const size_t remaining = segments_.front().size() - front_offset_;
+        if (bytes < remaining) {
+            front_offset_ += bytes;
+            return;
+        }
+        bytes -= remaining;
+        front_offset_ = 0;
+        segments_.pop_front();
+    }
+}
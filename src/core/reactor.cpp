@@ -0,0 +1,194 @@
+#include "core/reactor.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <memory>
+
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "core/connection.h"
+#include "utils/logger.h"
+#include "utils/socket.h"
+
+namespace {
+    constexpr int MAX_EVENTS = 1024;                                // 单次 epoll_wait 返回的最大事件数
+    constexpr std::chrono::milliseconds IDLE_CHECK_INTERVAL{1000};  // 空闲连接检查间隔
+    constexpr std::chrono::milliseconds ACCEPT_RETRY_DELAY{100};    // 描述符耗尽时暂停 accept 的时长
+}  // namespace
+
+Reactor::Reactor(const size_t reactor_id, const uint16_t port, const ConnectionOptions& options, Logger* logger,
+                 StaticFile* static_file, AccessLog* access_log, Metrics* metrics)
+    : id_(reactor_id),
+      port_(port),
+      options_(options),
+      logger_(logger),
+      static_file_(static_file),
+      access_log_(access_log),
+      metrics_(metrics) {
+    try {
+        listen_fd_ = Socket::createListener(port_, true);
+        epoll_manager_.addFd(listen_fd_, EPOLLIN | EPOLLET);
+    } catch (const std::exception& e) {
+        if (listen_fd_ != -1) {
+            close(listen_fd_);
+        }
+        LOG(logger_, LogLevel::ERROR, std::format("Reactor {} setup failed: {}", id_, e.what()));
+        throw;
+    }
+
+    LOG(logger_, LogLevel::INFO, std::format("Reactor {} listening on port {} (SO_REUSEPORT).", id_, port_));
+}
+
+Reactor::~Reactor() {
+    stop();
+    connections_.clear();
+    close(listen_fd_);
+}
+
+void Reactor::start() {
+    thread_ = std::thread([this] { loop(); });
+}
+
+void Reactor::join() {
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void Reactor::stop() {
+    if (!stop_.exchange(true) && thread_.joinable()) {
+        epoll_manager_.notify();
+    }
+    join();
+}
+
+void Reactor::loop() {
+    LOG(logger_, LogLevel::DEBUG, std::format("Reactor {} event loop started.", id_));
+
+    // 启用长连接时定期唤醒，以便回收空闲连接
+    const int wait_timeout = options_.keepalive_timeout > 0 ? static_cast<int>(IDLE_CHECK_INTERVAL.count()) : -1;
+
+    std::array<epoll_event, MAX_EVENTS> events{};
+    while (!stop_) {
+        // 暂停 accept 期间至多等待 ACCEPT_RETRY_DELAY，以便按时恢复监听
+        int timeout = wait_timeout;
+        if (accept_paused_) {
+            const auto retry_delay = static_cast<int>(ACCEPT_RETRY_DELAY.count());
+            timeout = timeout == -1 ? retry_delay : std::min(timeout, retry_delay);
+        }
+
+        const int event_count = epoll_manager_.wait(events, timeout);
+        for (int i = 0; i < event_count; ++i) {
+            const int event_fd = events.at(i).data.fd;
+            if (event_fd == listen_fd_) {
+                handleNewConnection();
+            } else if (event_fd == epoll_manager_.getEventFd()) {
+                epoll_manager_.clearNotify();
+            } else {
+                handleClient(event_fd);
+            }
+        }
+        resumeAcceptIfDue();
+        closeIdleConnections();
+    }
+
+    LOG(logger_, LogLevel::DEBUG, std::format("Reactor {} event loop exiting.", id_));
+}
+
+void Reactor::handleNewConnection() {
+    while (true) {
+        sockaddr_in client_addr{};
+        socklen_t len = sizeof(client_addr);
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        const int client_fd = accept(listen_fd_, reinterpret_cast<sockaddr*>(&client_addr), &len);
+        if (client_fd == -1) {
+            const int error = errno;
+            if (error == EAGAIN || error == EWOULDBLOCK) {
+                break;  // 无更多连接
+            }
+            if (error == EINTR || error == ECONNABORTED || error == EPROTO) {
+                continue;  // 被信号中断或对端在 accept 前已断开，继续处理队列中的其余连接
+            }
+
+            // 监听 socket 为边缘触发，直接返回会使积压的连接再也得不到通知：
+            // 先停止监听，ACCEPT_RETRY_DELAY 后重新注册，内核会据当前状态重新报告就绪
+            if (error == EMFILE || error == ENFILE) {
+                LOG(logger_, LogLevel::WARNING,
+                    std::format("Reactor {} out of file descriptors, pausing accept for {} ms.", id_,
+                                ACCEPT_RETRY_DELAY.count()));
+            } else {
+                LOG(logger_, LogLevel::ERROR,
+                    std::format("Reactor {} failed to accept client connection: {}, retrying in {} ms.", id_,
+                                std::strerror(error), ACCEPT_RETRY_DELAY.count()));
+            }
+            pauseAccept();
+            break;
+        }
+
+        // 设置客户端 socket 为非阻塞
+        Socket::setNonBlocking(client_fd);
+
+        try {
+            const auto conn = std::make_shared<Connection>(client_fd, client_addr, &epoll_manager_, logger_,
+                                                           static_file_, access_log_, metrics_, options_);
+
+            // 回调与事件循环处于同一线程，直接修改连接表即可
+            conn->setCloseRequestCallback([this](const int close_fd) { connections_.erase(close_fd); });
+            connections_[client_fd] = conn;
+        } catch (const std::exception& e) {
+            LOG(logger_, LogLevel::ERROR, std::format("Reactor {} failed to create connection: {}", id_, e.what()));
+            close(client_fd);
+        }
+    }
+}
+
+void Reactor::pauseAccept() {
+    epoll_manager_.modFd(listen_fd_, 0);
+    accept_paused_ = true;
+    accept_resume_time_ = std::chrono::steady_clock::now() + ACCEPT_RETRY_DELAY;
+}
+
+void Reactor::resumeAcceptIfDue() {
+    if (!accept_paused_ || std::chrono::steady_clock::now() < accept_resume_time_) {
+        return;
+    }
+    accept_paused_ = false;
+    epoll_manager_.modFd(listen_fd_, EPOLLIN | EPOLLET);
+}
+
+void Reactor::handleClient(const int client_fd) {
+    const auto iter = connections_.find(client_fd);
+    if (iter == connections_.end()) {
+        return;
+    }
+
+    // 持有一份引用，避免关闭回调在处理过程中析构连接对象
+    const std::shared_ptr<Connection> conn = iter->second;
+    try {
+        conn->handle();
+    } catch (const std::exception& e) {
+        LOG(logger_, LogLevel::ERROR, conn->info(), std::format("Reactor {} exception: {}", id_, e.what()));
+        connections_.erase(client_fd);
+    }
+}
+
+void Reactor::closeIdleConnections() {
+    if (options_.keepalive_timeout <= 0) {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_idle_check_ < IDLE_CHECK_INTERVAL) {
+        return;
+    }
+    last_idle_check_ = now;
+
+    std::erase_if(connections_, [now](const auto& item) { return item.second->closeIfIdle(now); });
+}
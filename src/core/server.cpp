@@ -2,96 +2,191 @@
 
 #include <array>
 #include <cerrno>
+#include <chrono>
 #include <cstdint>
 #include <format>
 #include <memory>
 #include <mutex>
 
-#include <fcntl.h>
 #include <netinet/in.h>
 #include <sys/epoll.h>
 #include <sys/socket.h>
 #include <unistd.h>
 
+#include "core/access_log.h"
 #include "core/connection.h"
+#include "core/metrics.h"
 #include "utils/logger.h"
+#include "utils/socket.h"
 
-constexpr int MAX_EVENTS = 1024;  // epoll 支持的最大事件数
+constexpr int MAX_EVENTS = 1024;                                // epoll 支持的最大事件数
+constexpr std::chrono::milliseconds IDLE_CHECK_INTERVAL{1000};  // 空闲连接检查间隔
 
 inline sockaddr* toSockaddr(sockaddr_in* addr) {
     return reinterpret_cast<sockaddr*>(addr);  // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
 }
 
-Server::Server(const uint16_t port, const bool linger, Logger* logger, const size_t thread_count)
-    : port_(port), linger_(linger), logger_(logger), thread_pool_(thread_count, logger) {
-    setupSocket();
-    setupEpoll();
+Server::Server(const uint16_t port, const ConnectionOptions& options, const StaticFileOptions& static_options,
+               const ThreadPoolOptions& pool_options, Logger* logger, AccessLog* access_log, Metrics* metrics,
+               const size_t reactor_count)
+    : port_(port),
+      options_(options),
+      logger_(logger),
+      access_log_(access_log),
+      metrics_(metrics),
+      thread_pool_(reactor_count > 0 ? ThreadPoolOptions{} : pool_options, logger),
+      static_file_(logger, static_options, "./static") {
+    setupWatcher();
+    if (reactor_count > 0) {
+        // 多 Reactor 模式：连接由接受它的事件循环线程直接处理，不经过线程池
+        setupReactors(reactor_count);
+    } else {
+        // 线程池模式下同一连接可能被多个线程同时取到，使用 EPOLLONESHOT 保证串行处理
+        options_.one_shot = true;
+        setupSocket();
+        setupEpoll();
+    }
+    if (metrics_ != nullptr) {
+        registerMetrics();
+    }
 }
 
 Server::~Server() {
-    close(listen_fd_);
-    logger_->log(LogLevel::INFO, "Server resources cleaned up and shutting down.");
+    reactors_.clear();
+    if (listen_fd_ != -1) {
+        close(listen_fd_);
+    }
+
+    const CacheStats stats = static_file_.cacheStats();
+    LOG(logger_, LogLevel::INFO,
+        std::format("Static file cache: {} hits, {} misses, {} evictions, {} entries, {} bytes.", stats.hits,
+                    stats.misses, stats.evictions, stats.entries, stats.bytes));
+    LOG(logger_, LogLevel::INFO, "Server resources cleaned up and shutting down.");
     logger_->logDivider("Server close");
 }
 
 void Server::setupSocket() {
-    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (listen_fd_ == -1) {
-        logger_->log(LogLevel::ERROR, "Failed to create socket.");
-        throw std::runtime_error("Failed to create socket.");
+    try {
+        listen_fd_ = Socket::createListener(port_);
+    } catch (const std::exception& e) {
+        LOG(logger_, LogLevel::ERROR, e.what());
+        throw;
     }
 
-    // 配置服务器地址结构
-    sockaddr_in addr{};
-    addr.sin_family = AF_INET;
-    addr.sin_port = htons(port_);
-    addr.sin_addr.s_addr = INADDR_ANY;
+    LOG(logger_, LogLevel::INFO, std::format("Listening on port {}", port_));
+}
 
-    // 设置 socket 选项：快速重用地址
-    constexpr int opt = 1;
-    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+void Server::setupEpoll() const {
+    try {
+        epoll_manager_.addFd(listen_fd_, EPOLLIN | EPOLLET);
+        LOG(logger_, LogLevel::INFO, "Epoll instance created and listening socket added.");
+    } catch (const std::exception& e) {
+        LOG(logger_, LogLevel::ERROR, std::format("Epoll setup failed: {}", e.what()));
+        throw;
+    }
+}
 
-    // 绑定 socket 到地址
-    if (bind(listen_fd_, toSockaddr(&addr), sizeof(addr)) == -1) {
-        logger_->log(LogLevel::ERROR, "Failed to bind socket.");
-        throw std::runtime_error("Failed to bind socket.");
+void Server::setupWatcher() const {
+    if (const int watch_fd = static_file_.watchFd(); watch_fd != -1) {
+        epoll_manager_.addFd(watch_fd, EPOLLIN);
+        LOG(logger_, LogLevel::INFO, "Static file watcher registered with epoll.");
     }
+}
 
-    // 开始监听连接请求
-    if (listen(listen_fd_, SOMAXCONN) == -1) {
-        logger_->log(LogLevel::ERROR, "Failed to listen on socket.");
-        throw std::runtime_error("Failed to listen on socket.");
+void Server::setupReactors(const size_t reactor_count) {
+    reactors_.reserve(reactor_count);
+    for (size_t i = 0; i < reactor_count; ++i) {
+        reactors_.emplace_back(
+            std::make_unique<Reactor>(i, port_, options_, logger_, &static_file_, access_log_, metrics_));
     }
+    LOG(logger_, LogLevel::INFO, std::format("Multi-reactor mode enabled with {} reactors.", reactor_count));
+}
 
-    // 设置监听 socket 为非阻塞
-    setNonBlocking(listen_fd_);
+void Server::registerMetrics() {
+    metrics_->addCollector([this](std::string& out) {
+        const CacheStats stats = static_file_.cacheStats();
+        Metrics::writeCounter(out, "webserver_static_cache_hits_total", "Static file cache hits.", stats.hits);
+        Metrics::writeCounter(out, "webserver_static_cache_misses_total", "Static file cache misses, including stale.",
+                              stats.misses);
+        Metrics::writeCounter(out, "webserver_static_cache_evictions_total",
+                              "Static file cache entries evicted for capacity.", stats.evictions);
+        Metrics::writeGauge(out, "webserver_static_cache_entries", "Static file cache entries.",
+                            static_cast<double>(stats.entries));
+        Metrics::writeGauge(out, "webserver_static_cache_bytes", "Bytes held by the static file cache.",
+                            static_cast<double>(stats.bytes));
+    });
 
-    logger_->log(LogLevel::INFO, std::format("Listening on port {}", port_));
-}
+    // 多 Reactor 模式不使用线程池
+    if (reactors_.empty()) {
+        metrics_->addCollector([this](std::string& out) {
+            constexpr double ns_per_second = 1e9;
+            const ThreadPoolStats stats = thread_pool_.stats();
+            Metrics::writeGauge(out, "webserver_threadpool_threads", "Active worker threads.",
+                                static_cast<double>(stats.threads));
+            Metrics::writeGauge(out, "webserver_threadpool_queued_tasks", "Tasks waiting in worker queues.",
+                                static_cast<double>(stats.queued));
+            Metrics::writeCounter(out, "webserver_threadpool_tasks_total", "Tasks executed by the thread pool.",
+                                  stats.tasks);
+            Metrics::writeCounter(out, "webserver_threadpool_queue_wait_seconds_total",
+                                  "Total time tasks spent queued before running.",
+                                  static_cast<double>(stats.wait_ns) / ns_per_second);
+            Metrics::writeCounter(out, "webserver_threadpool_busy_seconds_total", "Total time spent running tasks.",
+                                  static_cast<double>(stats.busy_ns) / ns_per_second);
+        });
+    }
 
-void Server::setupEpoll() const {
-    try {
-        epoll_manager_.addFd(listen_fd_, EPOLLIN | EPOLLET);
-        logger_->log(LogLevel::INFO, "Epoll instance created and listening socket added.");
-    } catch (const std::exception& e) {
-        logger_->log(LogLevel::ERROR, std::format("Epoll setup failed: {}", e.what()));
-        throw;
+    if (access_log_ != nullptr) {
+        metrics_->addCollector([this](std::string& out) {
+            Metrics::writeCounter(out, "webserver_access_log_records_total", "Access log records written.",
+                                  access_log_->recordCount());
+            Metrics::writeCounter(out, "webserver_access_log_dropped_total",
+                                  "Access log records dropped because no file was available.",
+                                  access_log_->droppedCount());
+        });
     }
 }
 
 void Server::run() {
     logger_->logDivider("Server start");
 
+    if (!reactors_.empty()) {
+        for (const auto& reactor : reactors_) {
+            reactor->start();
+        }
+        // 主线程不处理连接，只负责文件监视事件
+        if (static_file_.watchFd() != -1) {
+            std::array<epoll_event, MAX_EVENTS> events{};
+            while (true) {
+                const int event_count = epoll_manager_.wait(events);
+                for (int i = 0; i < event_count; ++i) {
+                    if (events.at(i).data.fd == static_file_.watchFd()) {
+                        static_file_.handleWatchEvents();
+                    }
+                }
+            }
+        }
+        for (const auto& reactor : reactors_) {
+            reactor->join();
+        }
+        return;
+    }
+
+    // 启用长连接时定期唤醒，以便回收空闲连接
+    const int wait_timeout = options_.keepalive_timeout > 0 ? static_cast<int>(IDLE_CHECK_INTERVAL.count()) : -1;
+
     std::array<epoll_event, MAX_EVENTS> events{};
     while (true) {
-        const int event_count = epoll_manager_.wait(events, -1);
+        const int event_count = epoll_manager_.wait(events, wait_timeout);
         for (int i = 0; i < event_count; ++i) {
             if (const int client_fd = events.at(i).data.fd; client_fd == listen_fd_) {
                 handleNewConnection();
+            } else if (client_fd == static_file_.watchFd()) {
+                static_file_.handleWatchEvents();
             } else {
                 dispatchClient(client_fd);
             }
         }
+        closeIdleConnections();
     }
 }
 
@@ -104,18 +199,18 @@ void Server::handleNewConnection() {
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
                 break;  // 无更多连接
             }
-            logger_->log(LogLevel::ERROR, "Failed to accept client connection.");
+            LOG(logger_, LogLevel::ERROR, "Failed to accept client connection.");
             throw std::runtime_error("Failed to accept client connection.");
         }
 
         // 设置客户端 socket 为非阻塞
-        setNonBlocking(client_fd);
+        Socket::setNonBlocking(client_fd);
 
-        const auto conn =
-            std::make_shared<Connection>(client_fd, client_addr, &epoll_manager_, logger_, &static_file_, linger_);
+        const auto conn = std::make_shared<Connection>(client_fd, client_addr, &epoll_manager_, logger_, &static_file_,
+                                                       access_log_, metrics_, options_);
 
         if (!conn) {
-            logger_->log(LogLevel::ERROR, "Failed to create connection object.");
+            LOG(logger_, LogLevel::ERROR, "Failed to create connection object.");
             close(client_fd);
             continue;
         }
@@ -142,18 +237,48 @@ void Server::dispatchClient(const int client_fd) {
     }
 
     if (!conn) {
-        logger_->log(LogLevel::WARNING, "Connection is null, cannot dispatch.");
+        LOG(logger_, LogLevel::WARNING, "Connection is null, cannot dispatch.");
         return;
     }
 
+    // 连接的引用直接移入任务，不再额外增减引用计数
+    bool queued = false;
     try {
-        thread_pool_.enqueue([conn] { conn->handle(); });
+        queued = thread_pool_.enqueue([conn = std::move(conn)] { conn->handle(); });
     } catch (const std::exception& e) {
-        logger_->log(LogLevel::ERROR, conn->info(), std::format("Failed to enqueue task: {}", e.what()));
+        LOG(logger_, LogLevel::ERROR, std::format("Failed to enqueue task: {}", e.what()));
+    }
+    if (!queued) {
+        shedClient(client_fd);
     }
 }
 
-int Server::setNonBlocking(const int socket_fd) {
-    const int old_flags = fcntl(socket_fd, F_GETFL);           // NOLINT(cppcoreguidelines-pro-type-vararg)
-    return fcntl(socket_fd, F_SETFL, old_flags | O_NONBLOCK);  // NOLINT(cppcoreguidelines-pro-type-vararg)
+void Server::shedClient(const int client_fd) {
+    // EPOLLONESHOT 下未被处理的连接不会再收到事件，直接关闭，避免过载时积压无上限
+    std::shared_ptr<Connection> conn;
+    {
+        std::lock_guard lock(connections_mutex_);
+        const auto iter = connections_.find(client_fd);
+        if (iter == connections_.end()) {
+            return;
+        }
+        conn = std::move(iter->second);
+        connections_.erase(iter);
+    }
+    LOG(logger_, LogLevel::WARNING, conn->info(), "Task queue is full, dropping connection.");
+}
+
+void Server::closeIdleConnections() {
+    if (options_.keepalive_timeout <= 0) {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    if (now - last_idle_check_ < IDLE_CHECK_INTERVAL) {
+        return;
+    }
+    last_idle_check_ = now;
+
+    std::lock_guard lock(connections_mutex_);
+    std::erase_if(connections_, [now](const auto& item) { return item.second->closeIfIdle(now); });
 }
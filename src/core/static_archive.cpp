@@ -0,0 +1,109 @@
+#include "core/static_archive.h"
+
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <initializer_list>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "utils/file_descriptor.h"
+#include "utils/mapped_file.h"
+
+StaticArchive::StaticArchive(const std::filesystem::path& path) {
+    const FileDescriptor file(open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (!file.valid()) {
+        throw std::runtime_error(std::format("Failed to open {}: {}", path.string(), strerror(errno)));
+    }
+
+    struct stat file_stat {};
+    if (fstat(file.get(), &file_stat) == -1) {
+        throw std::runtime_error(std::format("Failed to stat {}: {}", path.string(), strerror(errno)));
+    }
+    const auto size = static_cast<size_t>(file_stat.st_size);
+    if (!S_ISREG(file_stat.st_mode) || size < sizeof(ArchiveHeader)) {
+        throw std::runtime_error(std::format("{} is not a static archive", path.string()));
+    }
+
+    // 不预读整个文件：资源页在首次发送时才按需调入
+    mapping_ = std::make_shared<const MappedFile>(file.get(), size, false);
+    const std::string_view data = mapping_->view();
+
+    ArchiveHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != ArchiveFormat::MAGIC) {
+        throw std::runtime_error(std::format("{} is not a static archive", path.string()));
+    }
+    if (header.version != ArchiveFormat::VERSION) {
+        throw std::runtime_error(std::format("Unsupported static archive version {} (expected {})", header.version,
+                                             ArchiveFormat::VERSION));
+    }
+
+    const size_t count = header.entry_count;
+    const bool tables_valid = header.displacements_offset % ArchiveFormat::ALIGNMENT == 0 &&
+                              header.entries_offset % ArchiveFormat::ALIGNMENT == 0 &&
+                              header.displacements_offset <= size &&
+                              (size - header.displacements_offset) / sizeof(int32_t) >= count &&
+                              header.entries_offset <= size &&
+                              (size - header.entries_offset) / sizeof(ArchiveEntry) >= count;
+    if (!tables_valid) {
+        throw std::runtime_error(std::format("{} is truncated or corrupted", path.string()));
+    }
+
+    // 映射起始地址按页对齐，表的偏移按 ArchiveFormat::ALIGNMENT 对齐，可以直接按数组访问
+    // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast, cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    displacements_ = {reinterpret_cast<const int32_t*>(data.data() + header.displacements_offset), count};
+    entries_ = {reinterpret_cast<const ArchiveEntry*>(data.data() + header.entries_offset), count};
+    // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast, cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
+
+const ArchiveEntry* StaticArchive::find(const std::string_view path) const {
+    if (entries_.empty()) {
+        return nullptr;
+    }
+
+    const size_t slot = ArchiveFormat::slotOf(displacements_, path);
+    if (slot >= entries_.size()) {
+        return nullptr;
+    }
+    const ArchiveEntry& entry = entries_[slot];
+    // 区间在命中时才校验，加载耗时不随条目数增长
+    if (!isValid(entry) || view(entry.path) != path) {
+        return nullptr;
+    }
+    return &entry;
+}
+
+std::string_view StaticArchive::view(const ArchiveSpan& span) const {
+    return mapping_->view().substr(span.offset, span.length);
+}
+
+const std::shared_ptr<const MappedFile>& StaticArchive::mapping() const {
+    return mapping_;
+}
+
+size_t StaticArchive::entryCount() const {
+    return entries_.size();
+}
+
+bool StaticArchive::contains(const ArchiveSpan& span) const {
+    const size_t size = mapping_->size();
+    return span.offset <= size && span.length <= size - span.offset;
+}
+
+bool StaticArchive::isValid(const ArchiveEntry& entry) const {
+    if (!contains(entry.path)) {
+        return false;
+    }
+    for (const ArchiveRepresentation& representation : entry.representations) {
+        for (const ArchiveSpan* span : {&representation.header, &representation.not_modified, &representation.body,
+                                        &representation.etag, &representation.content_type}) {
+            if (!contains(*span)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
@@ -2,24 +2,59 @@
 
 #include <algorithm>
 #include <array>
+#include <cerrno>
 #include <cstddef>
+#include <cstdint>
+#include <ctime>
 #include <filesystem>
 #include <format>
-#include <fstream>
+#include <memory>
+#include <optional>
 #include <sstream>
+#include <stdexcept>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <system_error>
+#include <utility>
 #include <vector>
 
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "core/http_request.h"
 #include "core/http_response.h"
+#include "core/output_buffer.h"
+#include "utils/accept_encoding.h"
+#include "utils/etag.h"
+#include "utils/file_descriptor.h"
+#include "utils/gzip.h"
+#include "utils/http_date.h"
 #include "utils/logger.h"
+#include "utils/mapped_file.h"
 #include "utils/mime_type.h"
+#include "utils/openat2.h"
+#include "utils/range_parser.h"
 #include "utils/url.h"
 
 #define STR_HELPER(x) #x      // NOLINT(cppcoreguidelines-macro-usage)
 #define STR(x) STR_HELPER(x)  // NOLINT(cppcoreguidelines-macro-usage)
 
 namespace {
+    // 预压缩文件的编码与后缀，按压缩率从高到低排列（客户端 q 值相同时靠前者优先）
+    struct Precompressed {
+        std::string_view encoding;
+        std::string_view suffix;
+    };
+    constexpr std::array<Precompressed, 2> PRECOMPRESSED = {{{"br", ".br"}, {"gzip", ".gz"}}};
+
+    constexpr std::string_view BOUNDARY_PREFIX = "byteranges-";  // multipart/byteranges 分隔符前缀
+
+    std::string contentRange(const ByteRange& range, const size_t size) {
+        return std::format("bytes {}-{}/{}", range.offset, range.offset + range.length - 1, size);
+    }
+
     std::string formatSize(const std::uintmax_t bytes) {
         constexpr std::array<const char*, 5> units = {"B", "KB", "MB", "GB", "TB"};
         constexpr int base = 1024;
@@ -36,19 +71,47 @@ namespace {
         return oss.str();
     }
 
-    std::string formatTime(const std::filesystem::file_time_type file_time) {
-        const auto sctp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
-            file_time - std::filesystem::file_time_type::clock::now() + std::chrono::system_clock::now());
-        const auto raw_time = std::chrono::system_clock::to_time_t(sctp);
+    // 目录流的删除器，closedir 同时关闭 fdopendir 接管的描述符
+    struct DirCloser {
+        void operator()(DIR* dir) const { closedir(dir); }
+    };
+
+    std::string formatTime(const std::time_t raw_time) {
         const std::tm local_time = *std::localtime(&raw_time);
 
         std::ostringstream oss;
         oss << std::put_time(&local_time, "%Y-%m-%d %H:%M");
         return oss.str();
     }
+
+    // 读取 size 字节的文件内容并追加到 content 末尾，读取失败或文件被截断时返回 false
+    bool appendFileContent(const int file_fd, const size_t size, std::string& content) {
+        const size_t offset = content.size();
+        content.resize(offset + size);
+
+        size_t total = 0;
+        while (total < size) {
+            const ssize_t bytes_read = read(file_fd, content.data() + offset + total, size - total);
+            if (bytes_read == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            if (bytes_read == 0) {
+                return false;  // 文件在读取过程中被截断，与已生成的 Content-Length 不符
+            }
+            total += static_cast<size_t>(bytes_read);
+        }
+        return true;
+    }
 }  // namespace
 
-StaticFile::StaticFile(Logger* logger, const std::string_view relative_path) : logger_(logger) {
+StaticFile::StaticFile(Logger* logger, const StaticFileOptions& options, const std::string_view relative_path)
+    : options_(options),
+      logger_(logger),
+      cache_(options.cache_max_bytes, options.cache_max_entry_bytes),
+      fd_cache_(options.fd_cache_size) {
 #ifdef ROOT_PATH
     std::filesystem::path root_path = STR(ROOT_PATH);
 #else
@@ -56,87 +119,321 @@ StaticFile::StaticFile(Logger* logger, const std::string_view relative_path) : l
 #endif
 
     root_ = weakly_canonical(root_path / relative_path);
-    logger_->log(LogLevel::INFO, std::format("StaticFile initialized. Root: {}", root_.string()));
+    LOG(logger_, LogLevel::INFO, std::format("StaticFile initialized. Root: {}", root_.string()));
+
+    root_fd_ = FileDescriptor(open(root_.c_str(), O_PATH | O_DIRECTORY | O_CLOEXEC));
+    openat2_ = root_fd_.valid() && OpenAt2::supported(root_fd_.get());
+    if (openat2_) {
+        LOG(logger_, LogLevel::INFO, "Path resolution: openat2 (RESOLVE_BENEATH).");
+    } else {
+        LOG(logger_, LogLevel::WARNING, "openat2 is not available. Falling back to userspace path checks.");
+    }
+
+    if (options_.watch_files) {
+        try {
+            watcher_ = std::make_unique<FileWatcher>(
+                root_, [this](const std::filesystem::path& path, const bool recursive) {
+                    invalidate(path, recursive);
+                });
+            watching_.store(true);
+            LOG(logger_, LogLevel::INFO, std::format("Watching {} directories for changes.", watcher_->watchCount()));
+        } catch (const std::runtime_error& e) {
+            watcher_.reset();
+            LOG(logger_, LogLevel::WARNING, std::format("{} Falling back to mtime validation.", e.what()));
+        }
+    }
+
+    if (!options_.archive_path.empty()) {
+        const std::filesystem::path archive_path = root_path / options_.archive_path;
+        try {
+            archive_ = std::make_unique<StaticArchive>(archive_path);
+            LOG(logger_, LogLevel::INFO, std::format("Static archive loaded: {} ({} entries)", archive_path.string(),
+                                                     archive_->entryCount()));
+        } catch (const std::runtime_error& e) {
+            LOG(logger_, LogLevel::WARNING, std::format("{} Serving from the static directory.", e.what()));
+        }
+    }
 }
 
-std::string StaticFile::serve(const std::string& path, const Address& info) const {
+void StaticFile::serve(const HttpRequest& request, const Address& info, OutputBuffer& output) const {
+    const std::string path(request.path());
+    const bool keep_alive = request.keep_alive;
+    const bool head_only = request.method == "HEAD";
     const std::string decoded_path = Url::decode(path);
-    std::filesystem::path full_path = getFilePath(decoded_path);
+    const std::filesystem::path full_path = getFilePath(decoded_path);
 
-    logger_->log(LogLevel::DEBUG, info, std::format("Request for static file: {}", full_path.string()));
+    LOG(logger_, LogLevel::DEBUG, info, std::format("Request for static file: {}", full_path.string()));
 
-    if (!isPathSafe(full_path)) {
-        // 路径不安全，返回 403
-        logger_->log(LogLevel::DEBUG, info, "Path is not safe, return 403.");
+    if (!isUnderRoot(full_path)) {
+        // 路径越出根目录，返回 403
+        LOG(logger_, LogLevel::DEBUG, info, "Path is outside the root, return 403.");
         constexpr int error_code = 403;
-        return HttpResponse::buildErrorResponse(error_code);
+        output.append(HttpResponse::buildErrorResponse(error_code, "", keep_alive, head_only));
+        return;
     }
 
-    if (is_directory(full_path)) {
-        if (!path.ends_with('/')) {
-            std::string corrected_url = path + '/';
-            logger_->log(LogLevel::INFO, info,
-                         std::format("Redirecting to directory with trailing slash: {} -> {}", path, corrected_url));
+    const std::string_view relative_path = relativePath(full_path);
+    if (archive_) {
+        // 归档优先：资源在打包时已生成好全部响应，命中时不访问文件系统；未打包的路径回退到静态目录
+        if (const ArchiveEntry* entry = archive_->find(relative_path)) {
+            LOG(logger_, LogLevel::DEBUG, info, "Static file served from archive.");
+            appendArchiveEntry(*entry, request, output);
+            return;
+        }
+    }
+
+    // 条目只会在通过安全检查后写入，命中时无需再解析路径
+    if (const auto cached = readFromCache(full_path, info)) {
+        LOG(logger_, LogLevel::DEBUG, info, "Static file served from cache.");
+        appendCacheEntry(cached, request, output);
+        return;
+    }
+
+    // 在打开文件之前记录失效代数，读取期间文件若被修改，插入时会被发现
+    const uint64_t generation = cache_.generation(full_path);
+    const uint64_t fd_generation = fd_cache_.generation();
 
-            return HttpResponse{}
-                .setStatus("301 Moved Permanently")
-                .addHeader("Location", corrected_url)
-                .setContentType("text/plain")
-                .setBody("Redirecting to " + corrected_url)
-                .build();
+    // 热点大文件直接复用已打开的描述符（只在监视有效时写入），省去路径解析与 open / fstat
+    std::optional<CachedFile> opened_file = fd_cache_.find(full_path);
+    const bool fd_cached = opened_file.has_value();
+    bool through_symlink = false;
+    if (fd_cached) {
+        LOG(logger_, LogLevel::DEBUG, info, "File descriptor cache hit.");
+    } else {
+        OpenedFile opened = openBeneath(full_path, relative_path);
+        if (opened.status == OpenStatus::FORBIDDEN) {
+            // 解析结果越出根目录，返回 403
+            LOG(logger_, LogLevel::DEBUG, info, "Path is not safe, return 403.");
+            constexpr int error_code = 403;
+            output.append(HttpResponse::buildErrorResponse(error_code, "", keep_alive, head_only));
+            return;
+        }
+        if (opened.status == OpenStatus::OPENED && S_ISDIR(opened.file_stat.st_mode)) {
+            serveDirectory(request, info, full_path, opened.file.get(), generation, opened.through_symlink, output);
+            return;
         }
+        if (opened.status != OpenStatus::OPENED || !S_ISREG(opened.file_stat.st_mode)) {
+            // 找不到文件，返回 404
+            LOG(logger_, LogLevel::DEBUG, info, "Static file not found, return 404.");
+            constexpr int error_code = 404;
+            output.append(HttpResponse::buildErrorResponse(error_code, "", keep_alive, head_only));
+            return;
+        }
+        through_symlink = opened.through_symlink;
+        opened_file = CachedFile{.file = std::make_shared<const FileDescriptor>(std::move(opened.file)),
+                                 .file_stat = opened.file_stat};
+    }
+    const std::shared_ptr<const FileDescriptor>& file = opened_file->file;
+    const struct stat& file_stat = opened_file->file_stat;
+
+    // 校验器：ETag 由文件大小与纳秒级修改时间组成，Last-Modified 精确到秒
+    const auto file_size = static_cast<size_t>(file_stat.st_size);
+    const std::string etag = ETag::fromStat(file_stat);
+    const std::string content_type = MimeType::get(full_path);
+
+    // 文本类资源按 Accept-Encoding 协商，各种表示的响应都需要告知缓存代理
+    const bool compressible =
+        options_.compression && file_size >= Gzip::MIN_INPUT_SIZE && MimeType::isCompressible(content_type);
 
-        // 生成目录列表
-        logger_->log(LogLevel::DEBUG, info, std::format("Serving directory listing for: {}", full_path.string()));
-        return HttpResponse{}
-            .setStatus("200 OK")
-            .setContentType("text/html; charset=UTF-8")
-            .setBody(generateDirectoryListing(full_path, path))
-            .build();
+    HttpResponse builder;
+    builder.setContentType(content_type)
+        .addHeader("Accept-Ranges", "bytes")
+        .addHeader("Last-Modified", HttpDate::format(file_stat.st_mtim.tv_sec));
+    if (compressible) {
+        builder.addHeader("Vary", "Accept-Encoding");
     }
 
-    if (auto cached = readFromCache(full_path, info)) {
-        // 从缓存中取文件
-        logger_->log(LogLevel::DEBUG, info, "Static file served from cache.");
-        return cached->build();
+    if (options_.sendfile_threshold > 0 && file_size >= options_.sendfile_threshold) {
+        // 大文件：用户态只生成响应头，正文由 sendfile 从页缓存直接发送，不占用缓存；
+        // 客户端接受且存在预压缩文件时改为发送预压缩文件
+        if (!fd_cached && !through_symlink && watching_.load(std::memory_order_relaxed)) {
+            fd_cache_.insert(full_path, *opened_file, fd_generation);
+        }
+        if (compressible) {
+            if (auto sidecar = openPreferredSidecar(full_path, file_stat, request)) {
+                LOG(logger_, LogLevel::DEBUG, info, std::format("Precompressed {} file selected.", sidecar->encoding));
+                builder.addHeader("Content-Encoding", std::string(sidecar->encoding));
+                sendFile(request, info, std::make_shared<const FileDescriptor>(std::move(sidecar->file)),
+                         sidecar->file_stat, file_stat.st_mtim.tv_sec, content_type, builder, output);
+                return;
+            }
+        }
+
+        sendFile(request, info, file, file_stat, file_stat.st_mtim.tv_sec, content_type, builder, output);
+        return;
     }
 
-    std::ifstream file(full_path, std::ios::binary);
-    if (!file.is_open()) {
-        // 找不到文件，返回 404
-        logger_->log(LogLevel::DEBUG, info, "Static file not found, return 404.");
-        constexpr int error_code = 404;
-        return HttpResponse::buildErrorResponse(error_code);
+    builder.addHeader("ETag", etag);
+
+    // 200 与 304 的响应头都只序列化一次，之后的命中直接复用
+    auto response = std::make_shared<std::string>(builder.setStatus("200 OK").buildHeaderFields(file_size));
+    const std::string not_modified = builder.setStatus("304 Not Modified").buildHeaderFields(file_size);
+
+    const auto entry = std::make_shared<CacheEntry>();
+    entry->header_size = response->size();
+    entry->modified_time = file_stat.st_mtim.tv_sec;
+
+    if (options_.mmap_cache && file_size > 0) {
+        // mmap 缓存模式：正文直接引用文件映射，与页缓存共享物理页
+        try {
+            entry->mapping = std::make_shared<const MappedFile>(file->get(), file_size);
+            response->append(not_modified);
+            entry->setResponse(std::move(response));
+            if (compressible) {
+                addVariants(*entry, file->get(), full_path, file_stat, builder, etag);
+            }
+            if (updateCache(full_path, entry, generation, through_symlink)) {
+                LOG(logger_, LogLevel::DEBUG, info, "Static file mapped and cached.");
+            } else {
+                LOG(logger_, LogLevel::DEBUG, info, "Static file mapped, not cached.");
+            }
+
+            appendCacheEntry(entry, request, output);
+            return;
+        } catch (const std::runtime_error& e) {
+            LOG(logger_, LogLevel::WARNING, info,
+                std::format("{} Falling back to heap cache: {}", e.what(), full_path.string()));
+        }
     }
 
-    std::ostringstream oss;
-    oss << file.rdbuf();
+    response->reserve(entry->header_size + file_size + not_modified.size());
+    if (!appendFileContent(file->get(), file_size, *response)) {
+        LOG(logger_, LogLevel::ERROR, info, std::format("Failed to read static file: {}", full_path.string()));
+        constexpr int error_code = 500;
+        output.append(HttpResponse::buildErrorResponse(error_code, "", keep_alive, head_only));
+        return;
+    }
+    entry->body_size = file_size;
+    response->append(not_modified);
+    entry->setResponse(std::move(response));
+    if (compressible) {
+        addVariants(*entry, file->get(), full_path, file_stat, builder, etag);
+    }
+
+    // 存入缓存
+    if (updateCache(full_path, entry, generation, through_symlink)) {
+        LOG(logger_, LogLevel::DEBUG, info, "Static file loaded and cached.");
+    } else {
+        LOG(logger_, LogLevel::DEBUG, info, "Static file loaded, not cached.");
+    }
+
+    appendCacheEntry(entry, request, output);
+}
+
+void StaticFile::serveDirectory(const HttpRequest& request, const Address& info, const std::filesystem::path& full_path,
+                                const int dir_fd, const uint64_t generation, const bool through_symlink,
+                                OutputBuffer& output) const {
+    const std::string_view path = request.path();
+    if (!path.ends_with('/')) {
+        std::string corrected_url = std::string(path) + '/';
+        LOG(logger_, LogLevel::INFO, info,
+            std::format("Redirecting to directory with trailing slash: {} -> {}", path, corrected_url));
+
+        output.append(HttpResponse{}
+                          .setStatus("301 Moved Permanently")
+                          .addHeader("Location", corrected_url)
+                          .setContentType("text/plain")
+                          .setBody("Redirecting to " + corrected_url)
+                          .setKeepAlive(request.keep_alive)
+                          .setHeadOnly(request.method == "HEAD")
+                          .build());
+        return;
+    }
+
+    // 生成目录列表并以目录路径（带结尾斜杠）为键缓存，目录内容变化时随监视事件或目录修改时间失效
+    LOG(logger_, LogLevel::DEBUG, info, std::format("Serving directory listing for: {}", full_path.string()));
+    const std::shared_ptr<CacheEntry> entry = makeListingEntry(full_path, dir_fd);
+    if (updateCache(full_path, entry, generation, through_symlink)) {
+        LOG(logger_, LogLevel::DEBUG, info, "Directory listing generated and cached.");
+    } else {
+        LOG(logger_, LogLevel::DEBUG, info, "Directory listing generated, not cached.");
+    }
+
+    appendCacheEntry(entry, request, output);
+}
+
+std::shared_ptr<CacheEntry> StaticFile::makeListingEntry(const std::filesystem::path& dir_path,
+                                                         const int dir_fd) const {
+    std::time_t modified_time = 0;
+    const std::string body = generateDirectoryListing(dir_path, dir_fd, modified_time);
+    const std::string etag = ETag::fromContent(body);
 
     HttpResponse builder;
-    builder.setStatus("200 OK").setContentType(MimeType::get(full_path)).setBody(oss.str());
+    builder.setContentType("text/html; charset=UTF-8")
+        .addHeader("Last-Modified", HttpDate::format(modified_time))
+        .addHeader("ETag", etag);
+    if (options_.compression) {
+        builder.addHeader("Vary", "Accept-Encoding");
+    }
 
-    // 存入缓存
-    updateCache(full_path, builder);
-    logger_->log(LogLevel::DEBUG, info, "Static file loaded and cached.");
+    auto response = std::make_shared<std::string>(builder.setStatus("200 OK").buildHeaderFields(body.size()));
+    auto entry = std::make_shared<CacheEntry>();
+    entry->header_size = response->size();
+    entry->body_size = body.size();
+    entry->modified_time = modified_time;
+    response->append(body);
+    response->append(builder.setStatus("304 Not Modified").buildHeaderFields(body.size()));
+    entry->setResponse(std::move(response));
 
-    return builder.build();
+    if (options_.compression) {
+        // 列表只在目录变化后生成一次，可以使用最高压缩级别
+        try {
+            if (const std::string compressed = Gzip::compress(body); compressed.size() < body.size()) {
+                entry->gzip =
+                    makeVariant(compressed, "gzip", ETag::withSuffix(etag, Gzip::ETAG_SUFFIX), builder, modified_time);
+            }
+        } catch (const std::runtime_error& e) {
+            LOG(logger_, LogLevel::WARNING, std::format("{} Serving identity encoding.", e.what()));
+        }
+    }
+    return entry;
 }
 
-std::string StaticFile::generateDirectoryListing(const std::filesystem::path& dir_path,
-                                                 const std::string& request_path) {
-    std::vector<std::filesystem::directory_entry> directories;
-    std::vector<std::filesystem::directory_entry> files;
+std::string StaticFile::generateDirectoryListing(const std::filesystem::path& dir_path, const int dir_fd,
+                                                 std::time_t& modified_time) const {
+    struct ListingItem {
+        std::string name;
+        struct stat file_stat {};
+    };
+    std::vector<ListingItem> directories;
+    std::vector<ListingItem> files;
 
-    for (const auto& entry : std::filesystem::directory_iterator(dir_path)) {
-        if (entry.is_directory()) {
-            directories.emplace_back(entry);
-        } else {
-            files.emplace_back(entry);
+    const std::filesystem::path dir = dir_path.has_filename() ? dir_path : dir_path.parent_path();
+    const std::filesystem::path relative_dir = dir.lexically_relative(root_);
+    const std::string request_path = relative_dir == "." ? "/" : "/" + relative_dir.generic_string() + "/";
+
+    // 遍历已经通过根目录检查打开的描述符，不再按路径重新解析（期间目录可能被替换为指向根目录之外的符号链接）；
+    // closedir 会关闭 fdopendir 接管的描述符，因此先复制一份
+    const int listing_fd = fcntl(dir_fd, F_DUPFD_CLOEXEC, 0);
+    const std::unique_ptr<DIR, DirCloser> stream(listing_fd == -1 ? nullptr : fdopendir(listing_fd));
+    if (!stream) {
+        const int error = errno;
+        if (listing_fd != -1) {
+            close(listing_fd);
         }
+        throw std::system_error(error, std::generic_category(), "Failed to list directory " + dir.string());
     }
 
-    auto filename_less = [](const auto& lhs_entry, const auto& rhs_entry) {
-        return lhs_entry.path().filename().string() < rhs_entry.path().filename().string();
+    // 列表显示各项的大小与修改时间，Last-Modified 取其中最新者（目录项增删会更新目录自身的修改时间）
+    struct stat dir_stat {};
+    if (fstat(dir_fd, &dir_stat) == -1) {
+        throw std::system_error(errno, std::generic_category(), "Failed to stat directory " + dir.string());
+    }
+    modified_time = dir_stat.st_mtim.tv_sec;
+
+    while (const dirent* entry = readdir(stream.get())) {
+        const std::string_view name = entry->d_name;
+        ListingItem item{.name = std::string(name), .file_stat = {}};
+        // 与原先一样跟随符号链接显示目标的状态，悬空的链接不列出
+        if (name == "." || name == ".." || fstatat(dir_fd, item.name.c_str(), &item.file_stat, 0) == -1) {
+            continue;
+        }
+        modified_time = std::max(modified_time, item.file_stat.st_mtim.tv_sec);
+        (S_ISDIR(item.file_stat.st_mode) ? directories : files).push_back(std::move(item));
+    }
+
+    auto filename_less = [](const ListingItem& lhs_item, const ListingItem& rhs_item) {
+        return lhs_item.name < rhs_item.name;
     };
     std::ranges::sort(directories, filename_less);
     std::ranges::sort(files, filename_less);
@@ -149,7 +446,7 @@ std::string StaticFile::generateDirectoryListing(const std::filesystem::path& di
 <head>
     <meta charset="UTF-8">
     <title>Index of )"
-         << Url::decode(request_path) << R"(</title>
+         << request_path << R"(</title>
     <style>
         body { font-family: 'Segoe UI', sans-serif; background-color: #f8f9fa; color: #343a40; padding: 2rem 3rem; }
         h1 { color: #007bff; font-size: 2.5rem; line-height: 1.2; margin-bottom: 2rem; }
@@ -164,7 +461,7 @@ std::string StaticFile::generateDirectoryListing(const std::filesystem::path& di
 </head>
 <body>
     <h1>📁 Index of )"
-         << Url::decode(request_path) << R"(</h1>
+         << request_path << R"(</h1>
     <table>
         <tr>
             <th>Name</th>
@@ -184,16 +481,11 @@ std::string StaticFile::generateDirectoryListing(const std::filesystem::path& di
     )";
     }
 
-    std::string base_path = request_path;
-    if (!base_path.empty() && base_path.back() != '/') {
-        base_path += '/';
-    }
-
     // 目录
-    for (const auto& dir : directories) {
-        const std::string name = dir.path().filename().string();
-        const std::string href = (std::filesystem::path(base_path) / Url::encode(name)).string() + '/';
-        const std::string time = formatTime(last_write_time(dir));
+    for (const auto& directory : directories) {
+        const std::string& name = directory.name;
+        const std::string href = Url::encode(name) + '/';
+        const std::string time = formatTime(directory.file_stat.st_mtim.tv_sec);
 
         html << std::format(R"(
         <tr>
@@ -207,10 +499,10 @@ std::string StaticFile::generateDirectoryListing(const std::filesystem::path& di
 
     // 文件
     for (const auto& file : files) {
-        const std::string name = file.path().filename().string();
-        const std::string href = (std::filesystem::path(base_path) / Url::encode(name)).string();
-        const std::string size = formatSize(file_size(file));
-        const std::string time = formatTime(last_write_time(file));
+        const std::string& name = file.name;
+        const std::string href = Url::encode(name);
+        const std::string size = formatSize(static_cast<std::uintmax_t>(file.file_stat.st_size));
+        const std::string time = formatTime(file.file_stat.st_mtim.tv_sec);
 
         html << std::format(R"(
         <tr>
@@ -231,47 +523,507 @@ std::string StaticFile::generateDirectoryListing(const std::filesystem::path& di
     return html.str();
 }
 
-bool StaticFile::isPathSafe(const std::filesystem::path& path) const {
-    return weakly_canonical(path).string().starts_with(root_.string());
+bool StaticFile::isUnderRoot(const std::filesystem::path& path) const {
+    return std::mismatch(root_.begin(), root_.end(), path.begin(), path.end()).first == root_.end();
+}
+
+std::string_view StaticFile::relativePath(const std::filesystem::path& full_path) const {
+    std::string_view relative = std::string_view(full_path.native()).substr(root_.native().size());
+    while (relative.starts_with('/')) {
+        relative.remove_prefix(1);
+    }
+    return relative;
+}
+
+StaticFile::OpenedFile StaticFile::openBeneath(const std::filesystem::path& full_path,
+                                               const std::string_view relative_path) const {
+    OpenedFile opened;
+    int file_fd = -1;
+    if (openat2_) {
+        // 先禁止解析任何符号链接，常见情况下一次系统调用完成；路径中确实存在符号链接时再允许其在根目录内解析
+        const std::string relative = relative_path.empty() ? "." : std::string(relative_path);
+        file_fd = OpenAt2::open(root_fd_.get(), relative.c_str(), O_RDONLY | O_CLOEXEC,
+                                RESOLVE_BENEATH | RESOLVE_NO_SYMLINKS);
+        if (file_fd == -1 && errno == ELOOP) {
+            opened.through_symlink = true;
+            file_fd = OpenAt2::open(root_fd_.get(), relative.c_str(), O_RDONLY | O_CLOEXEC,
+                                    RESOLVE_BENEATH | RESOLVE_NO_MAGICLINKS);
+        }
+        if (file_fd == -1 && errno != EXDEV) {
+            // ELOOP：魔术链接或链接层数过多
+            opened.status = errno == ELOOP ? OpenStatus::FORBIDDEN : OpenStatus::NOT_FOUND;
+            return opened;
+        }
+        opened.file = FileDescriptor(file_fd);
+    }
+
+    if (!opened.file.valid()) {
+        // 不支持 openat2，或解析越出了根目录（EXDEV，如绝对路径的符号链接，可能仍指向根目录之内）：
+        // 解析符号链接后再检查，防止通过链接访问根目录之外的文件
+        std::error_code error;
+        const std::filesystem::path canonical = weakly_canonical(full_path, error);
+        if (error || !isUnderRoot(canonical)) {
+            opened.status = error ? OpenStatus::NOT_FOUND : OpenStatus::FORBIDDEN;
+            return opened;
+        }
+        opened.through_symlink = canonical != (full_path.has_filename() ? full_path : full_path.parent_path());
+        opened.file = FileDescriptor(open(full_path.c_str(), O_RDONLY | O_CLOEXEC));
+    }
+
+    if (opened.file.valid() && fstat(opened.file.get(), &opened.file_stat) == 0) {
+        opened.status = OpenStatus::OPENED;
+    }
+    return opened;
 }
 
 std::filesystem::path StaticFile::getFilePath(const std::string& path) const {
     const std::string clean_path = path == "/" ? "index.html" : path.substr(1);
-    return root_ / clean_path;
+    return (root_ / clean_path).lexically_normal();
+}
+
+std::shared_ptr<const CacheEntry> StaticFile::readFromCache(const std::filesystem::path& path,
+                                                            const Address& info) const {
+    std::optional<std::filesystem::file_time_type> last_modified;
+    if (!watching_.load(std::memory_order_relaxed)) {
+        // 未启用文件监视时，每次命中都需要确认文件未被修改（在缓存锁之外完成）
+        std::error_code error;
+        last_modified = last_write_time(path, error);
+        if (error) {
+            LOG(logger_, LogLevel::DEBUG, info, std::format("Cache erase (file missing): {}", path.string()));
+            cache_.erase(path);
+            return nullptr;
+        }
+    }
+
+    auto cached = cache_.find(path, last_modified);
+    LOG(logger_, LogLevel::DEBUG, info, std::format("Cache {}: {}", cached ? "hit" : "miss", path.string()));
+    return cached;
+}
+
+bool StaticFile::updateCache(const std::filesystem::path& path, const std::shared_ptr<CacheEntry>& entry,
+                             const uint64_t generation, const bool through_symlink) const {
+    try {
+        if (through_symlink && watching_.load(std::memory_order_relaxed)) {
+            // 经由符号链接访问的文件可能位于监视范围之外，不缓存
+            return false;
+        }
+
+        entry->last_modified = last_write_time(path);
+        return cache_.insert(path, entry, generation);
+    } catch (const std::filesystem::filesystem_error& e) {
+        // 极端文件丢失情况
+        LOG(logger_, LogLevel::ERROR, std::format("updateCache failed: {} ({})", e.what(), path.string()));
+        return false;
+    }
+}
+
+void StaticFile::invalidate(const std::filesystem::path& path, const bool recursive) const {
+    LOG(logger_, LogLevel::DEBUG, std::format("Cache invalidated{}: {}", recursive ? " (tree)" : "", path.string()));
+
+    // 所在目录的列表（键带有结尾斜杠）一并失效
+    cache_.erase(path.parent_path() / "");
+    if (recursive) {
+        cache_.eraseUnder(path);
+        fd_cache_.eraseUnder(path);
+        return;
+    }
+
+    cache_.erase(path);
+    fd_cache_.erase(path);
+
+    // 预压缩文件变化时，原文件缓存条目中保存的压缩变体也随之失效
+    const std::filesystem::path extension = path.extension();
+    if (std::ranges::any_of(PRECOMPRESSED, [&extension](const Precompressed& precompressed) {
+            return extension == precompressed.suffix;
+        })) {
+        cache_.erase(path.parent_path() / path.stem());
+    }
 }
 
-std::optional<HttpResponse> StaticFile::readFromCache(const std::filesystem::path& path, const Address& info) const {
-    std::lock_guard lock(cache_mutex_);
-    const auto cache_iter = cache_.find(path);
+CacheStats StaticFile::cacheStats() const {
+    return cache_.stats();
+}
+
+void StaticFile::appendCacheEntry(const std::shared_ptr<const CacheEntry>& cached, const HttpRequest& request,
+                                  OutputBuffer& output) {
+    // 客户端接受压缩编码时发送预先压缩好的变体，不再消耗 CPU；
+    // 头部与正文都由缓存条目本身持有（条目持有变体、响应与映射），不再逐个复制内部的 shared_ptr
+    const CacheEntry& entry = selectVariant(*cached, request);
+
+    const std::string_view response = *entry.response;
+    const Representation representation{
+        .header = response.substr(0, entry.header_size),
+        .not_modified = entry.notModifiedHeader(),
+        .body = entry.mapping ? entry.mapping->view() : response.substr(entry.header_size, entry.body_size),
+        .etag = entry.etag,
+        .content_type = entry.content_type,
+        .modified_time = entry.modified_time,
+        .header_owner = cached,
+        .body_owner = cached};
+    appendRepresentation(representation, request, output);
+}
+
+void StaticFile::appendArchiveEntry(const ArchiveEntry& entry, const HttpRequest& request,
+                                    OutputBuffer& output) const {
+    const auto& representations = entry.representations;
+    const std::string_view encoding =
+        negotiateEncoding(request, options_.compression && representations[ArchiveEntry::BROTLI].header.length > 0,
+                          options_.compression && representations[ArchiveEntry::GZIP].header.length > 0);
+    const ArchiveRepresentation& selected = encoding == "br"     ? representations[ArchiveEntry::BROTLI]
+                                            : encoding == "gzip" ? representations[ArchiveEntry::GZIP]
+                                                                 : representations[ArchiveEntry::IDENTITY];
+
+    // 所有部分都引用同一个映射
+    const Representation representation{.header = archive_->view(selected.header),
+                                        .not_modified = archive_->view(selected.not_modified),
+                                        .body = archive_->view(selected.body),
+                                        .etag = archive_->view(selected.etag),
+                                        .content_type = archive_->view(selected.content_type),
+                                        .modified_time = entry.modified_time,
+                                        .header_owner = archive_->mapping(),
+                                        .body_owner = archive_->mapping()};
+    appendRepresentation(representation, request, output);
+}
+
+void StaticFile::appendRepresentation(const Representation& representation, const HttpRequest& request,
+                                      OutputBuffer& output) {
+    // 各部分均以视图追加，由引用计数保证发送期间有效，整个响应不发生拷贝
+    if (isNotModified(request, representation.etag, representation.modified_time)) {
+        output.append(representation.not_modified, representation.header_owner);
+        output.append(HttpResponse::connectionLine(request.keep_alive), nullptr);
+        return;
+    }
+
+    if (const auto range = rangeHeader(request)) {
+        const RangeSource source{.content_type = representation.content_type,
+                                 .etag = representation.etag,
+                                 .modified_time = representation.modified_time,
+                                 .size = representation.body.size(),
+                                 .data = representation.body,
+                                 .file_fd = -1,
+                                 .owner = representation.body_owner};
+        if (appendRanges(request, *range, source, output)) {
+            return;
+        }
+    }
+
+    output.append(representation.header, representation.header_owner);
+    output.append(HttpResponse::connectionLine(request.keep_alive), nullptr);
+    if (request.method == "HEAD") {
+        return;
+    }
+    output.append(representation.body, representation.body_owner);
+}
+
+bool StaticFile::isNotModified(const HttpRequest& request, const std::string_view etag,
+                               const std::time_t modified_time) {
+    // If-None-Match 优先，存在时忽略 If-Modified-Since（RFC 9110 13.2.2）
+    if (const auto if_none_match = request.header("If-None-Match")) {
+        return ETag::matchesAny(*if_none_match, etag);
+    }
 
-    if (cache_iter == cache_.end()) {
-        logger_->log(LogLevel::DEBUG, info, std::format("Cache miss: {}", path.string()));
+    if (const auto if_modified_since = request.header("If-Modified-Since")) {
+        const auto since = HttpDate::parse(*if_modified_since);
+        return since && modified_time <= *since;
+    }
+
+    return false;
+}
+
+std::optional<std::string_view> StaticFile::rangeHeader(const HttpRequest& request) {
+    if (request.method != "GET") {
         return std::nullopt;
     }
+    return request.header("Range");
+}
+
+bool StaticFile::appendRanges(const HttpRequest& request, const std::string_view range, const RangeSource& source,
+                              OutputBuffer& output) {
+    if (!matchesIfRange(request, source.etag, source.modified_time)) {
+        return false;  // 资源已变化，发送完整的新版本
+    }
+
+    const auto [status, ranges] = RangeParser::parse(range, source.size);
+    if (status == RangeParser::Status::IGNORED) {
+        return false;
+    }
 
-    if (!exists(path)) {
-        logger_->log(LogLevel::DEBUG, info, std::format("Cache erase (file missing): {}", path.string()));
-        cache_.erase(cache_iter);
+    HttpResponse builder;
+    builder.addHeader("Accept-Ranges", "bytes").setKeepAlive(request.keep_alive);
+    if (status == RangeParser::Status::UNSATISFIABLE) {
+        output.append(builder.setStatus("416 Range Not Satisfiable")
+                          .addHeader("Content-Range", std::format("bytes */{}", source.size))
+                          .buildHeader(0));
+        return true;
+    }
+
+    builder.setStatus("206 Partial Content")
+        .addHeader("ETag", std::string(source.etag))
+        .addHeader("Last-Modified", HttpDate::format(source.modified_time));
+
+    // 正文直接引用缓存内容或文件片段，不拷贝
+    const auto append_body = [&source, &output](const ByteRange& byte_range) {
+        if (source.file_fd != -1) {
+            output.appendFile(source.file_fd, static_cast<off_t>(byte_range.offset), byte_range.length, source.owner);
+        } else {
+            output.append(source.data.substr(byte_range.offset, byte_range.length), source.owner);
+        }
+    };
+
+    if (ranges.size() == 1) {
+        const ByteRange& byte_range = ranges.front();
+        output.append(builder.setContentType(std::string(source.content_type))
+                          .addHeader("Content-Range", contentRange(byte_range, source.size))
+                          .buildHeader(byte_range.length));
+        append_body(byte_range);
+        return true;
+    }
+
+    // 多个范围：multipart/byteranges，每个部分带有自己的 Content-Type 与 Content-Range，总长度需预先算出
+    const std::string boundary = std::format("{}{}", BOUNDARY_PREFIX, source.etag.substr(1, source.etag.size() - 2));
+    std::vector<std::string> part_headers;
+    part_headers.reserve(ranges.size());
+    size_t content_length = 0;
+    for (const ByteRange& byte_range : ranges) {
+        part_headers.push_back(std::format("\r\n--{}\r\nContent-Type: {}\r\nContent-Range: {}\r\n\r\n", boundary,
+                                           source.content_type, contentRange(byte_range, source.size)));
+        content_length += part_headers.back().size() + byte_range.length;
+    }
+    std::string closing = std::format("\r\n--{}--\r\n", boundary);
+    content_length += closing.size();
+
+    output.append(builder.setContentType("multipart/byteranges; boundary=" + boundary).buildHeader(content_length));
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        output.append(std::move(part_headers[i]));
+        append_body(ranges[i]);
+    }
+    output.append(std::move(closing));
+    return true;
+}
+
+bool StaticFile::matchesIfRange(const HttpRequest& request, const std::string_view etag,
+                                const std::time_t modified_time) {
+    const auto if_range = request.header("If-Range");
+    if (!if_range) {
+        return true;
+    }
+
+    // 实体标签以引号开头（弱标签 W/ 不能用于 If-Range），否则为 HTTP 日期
+    if (if_range->starts_with('"')) {
+        return *if_range == etag;
+    }
+    const auto date = HttpDate::parse(*if_range);
+    return date && *date == modified_time;
+}
+
+void StaticFile::sendFile(const HttpRequest& request, const Address& info, std::shared_ptr<const FileDescriptor> file,
+                          const struct stat& file_stat, const std::time_t modified_time,
+                          const std::string_view content_type, HttpResponse builder, OutputBuffer& output) const {
+    const auto file_size = static_cast<size_t>(file_stat.st_size);
+    const std::string etag = ETag::fromStat(file_stat);
+    builder.addHeader("ETag", etag).setKeepAlive(request.keep_alive);
+
+    if (isNotModified(request, etag, modified_time)) {
+        LOG(logger_, LogLevel::DEBUG, info, "Static file not modified, return 304.");
+        output.append(builder.setStatus("304 Not Modified").buildHeader(file_size));
+        return;
+    }
+
+    if (const auto range = rangeHeader(request)) {
+        const RangeSource source{.content_type = content_type,
+                                 .etag = etag,
+                                 .modified_time = modified_time,
+                                 .size = file_size,
+                                 .data = {},
+                                 .file_fd = file->get(),
+                                 .owner = file};
+        if (appendRanges(request, *range, source, output)) {
+            LOG(logger_, LogLevel::DEBUG, info, std::format("Static file range sent with sendfile: {}", *range));
+            return;
+        }
+    }
+
+    LOG(logger_, LogLevel::DEBUG, info, std::format("Static file sent with sendfile ({} bytes).", file_size));
+    output.append(builder.setStatus("200 OK").buildHeader(file_size));
+    if (request.method != "HEAD") {
+        output.appendFile(file->get(), 0, file_size, file);
+    }
+}
+
+void StaticFile::addVariants(CacheEntry& entry, const int file_fd, const std::filesystem::path& path,
+                             const struct stat& file_stat, const HttpResponse& builder,
+                             const std::string_view etag) const {
+    // 预压缩文件优先（由构建时的 precompress 目标以最高压缩率生成）
+    for (const auto& [encoding, suffix] : PRECOMPRESSED) {
+        auto sidecar = openSidecar(path, suffix, file_stat);
+        if (!sidecar) {
+            continue;
+        }
+
+        std::string content;
+        content.reserve(static_cast<size_t>(sidecar->file_stat.st_size));
+        if (!appendFileContent(sidecar->file.get(), static_cast<size_t>(sidecar->file_stat.st_size), content)) {
+            continue;
+        }
+        auto variant = makeVariant(content, encoding, ETag::fromStat(sidecar->file_stat), builder, entry.modified_time);
+        (encoding == "br" ? entry.brotli : entry.gzip) = std::move(variant);
+    }
+    if (entry.gzip) {
+        return;
+    }
+
+    // 没有 gzip 预压缩文件时在此压缩一次，压缩结果随条目缓存。
+    // 用户态从不直接读取映射：文件被原地截断后读取映射会触发 SIGBUS，而 writev 等系统调用只会返回 EFAULT
+    std::string content;
+    std::string_view body = std::string_view(*entry.response).substr(entry.header_size, entry.body_size);
+    if (entry.mapping) {
+        if (!appendFileContent(file_fd, entry.mapping->size(), content)) {
+            return;
+        }
+        body = content;
+    }
+    std::string compressed;
+    try {
+        compressed = Gzip::compress(body);
+    } catch (const std::runtime_error& e) {
+        LOG(logger_, LogLevel::WARNING, std::format("{} Serving identity encoding.", e.what()));
+        return;
+    }
+    if (compressed.size() >= body.size()) {
+        return;  // 压缩无收益
+    }
+
+    // 不同编码是不同的表示，强 ETag 必须不同
+    entry.gzip =
+        makeVariant(compressed, "gzip", ETag::withSuffix(etag, Gzip::ETAG_SUFFIX), builder, entry.modified_time);
+}
+
+std::shared_ptr<const CacheEntry> StaticFile::makeVariant(const std::string_view body, const std::string_view encoding,
+                                                          const std::string& etag, HttpResponse builder,
+                                                          const std::time_t modified_time) {
+    builder.addHeader("Content-Encoding", std::string(encoding)).addHeader("ETag", etag);
+
+    auto response = std::make_shared<std::string>(builder.setStatus("200 OK").buildHeaderFields(body.size()));
+    auto variant = std::make_shared<CacheEntry>();
+    variant->header_size = response->size();
+    variant->body_size = body.size();
+    variant->modified_time = modified_time;
+    response->append(body);
+    response->append(builder.setStatus("304 Not Modified").buildHeaderFields(body.size()));
+    variant->setResponse(std::move(response));
+    return variant;
+}
+
+std::string_view StaticFile::negotiateEncoding(const HttpRequest& request, const bool brotli_available,
+                                               const bool gzip_available) {
+    if (!brotli_available && !gzip_available) {
+        return {};
+    }
+    const auto accept_encoding = request.header("Accept-Encoding");
+    if (!accept_encoding) {
+        return {};
+    }
+
+    // q 值相同时优先压缩率更高的 br
+    const double brotli_quality = brotli_available ? AcceptEncoding::quality(*accept_encoding, "br") : 0.0;
+    const double gzip_quality = gzip_available ? AcceptEncoding::quality(*accept_encoding, "gzip") : 0.0;
+    if (brotli_quality > 0 && brotli_quality >= gzip_quality) {
+        return "br";
+    }
+    if (gzip_quality > 0) {
+        return "gzip";
+    }
+    return {};
+}
+
+const CacheEntry& StaticFile::selectVariant(const CacheEntry& cached, const HttpRequest& request) {
+    const std::string_view encoding = negotiateEncoding(request, cached.brotli != nullptr, cached.gzip != nullptr);
+    if (encoding == "br") {
+        return *cached.brotli;
+    }
+    if (encoding == "gzip") {
+        return *cached.gzip;
+    }
+    return cached;
+}
+
+std::optional<StaticFile::Sidecar> StaticFile::openPreferredSidecar(const std::filesystem::path& path,
+                                                                    const struct stat& original,
+                                                                    const HttpRequest& request) const {
+    const auto accept_encoding = request.header("Accept-Encoding");
+    if (!accept_encoding) {
         return std::nullopt;
     }
 
-    if (cache_iter->second.last_modified != last_write_time(path)) {
-        logger_->log(LogLevel::DEBUG, info, std::format("Cache stale: {}", path.string()));
+    std::array<double, PRECOMPRESSED.size()> qualities{};
+    for (size_t i = 0; i < PRECOMPRESSED.size(); ++i) {
+        qualities.at(i) = AcceptEncoding::quality(*accept_encoding, PRECOMPRESSED.at(i).encoding);
+    }
+
+    // 按 q 值从高到低尝试（相同时按表中顺序），预压缩文件不存在或已过期时尝试下一种编码
+    while (true) {
+        const auto best = std::ranges::max_element(qualities);
+        if (*best <= 0) {
+            return std::nullopt;
+        }
+        *best = 0;
+
+        const auto& precompressed = PRECOMPRESSED.at(static_cast<size_t>(best - qualities.begin()));
+        if (auto sidecar = openSidecar(path, precompressed.suffix, original)) {
+            sidecar->encoding = precompressed.encoding;
+            return sidecar;
+        }
+    }
+}
+
+std::optional<StaticFile::Sidecar> StaticFile::openSidecar(const std::filesystem::path& path,
+                                                           const std::string_view suffix,
+                                                           const struct stat& original) const {
+    // 与原文件一样在根目录之下解析，且路径中任何位置都不跟随符号链接，避免预压缩文件或其所在目录指向根目录之外；
+    // O_NONBLOCK 防止以 FIFO 冒充的预压缩文件阻塞 open（对普通文件的读取没有影响）
+    constexpr int flags = O_RDONLY | O_CLOEXEC | O_NONBLOCK;
+    FileDescriptor file;
+    if (openat2_) {
+        const std::string relative = std::string(relativePath(path)).append(suffix);
+        file = FileDescriptor(
+            OpenAt2::open(root_fd_.get(), relative.c_str(), flags, RESOLVE_BENEATH | RESOLVE_NO_SYMLINKS));
+    } else {
+        // 不支持 openat2 时只能保证最后一级不是符号链接，所在目录已随原文件检查过
+        file = FileDescriptor(open(sidecarPath(path, suffix).c_str(), flags | O_NOFOLLOW));
+    }
+    struct stat file_stat {};
+    if (!file.valid() || fstat(file.get(), &file_stat) == -1 || !S_ISREG(file_stat.st_mode)) {
         return std::nullopt;
     }
 
-    logger_->log(LogLevel::DEBUG, info, std::format("Cache hit: {}", path.string()));
-    return cache_iter->second.builder;
+    // 比原文件旧的预压缩文件已过期
+    const auto& sidecar_time = file_stat.st_mtim;
+    const auto& original_time = original.st_mtim;
+    if (sidecar_time.tv_sec < original_time.tv_sec ||
+        (sidecar_time.tv_sec == original_time.tv_sec && sidecar_time.tv_nsec < original_time.tv_nsec)) {
+        return std::nullopt;
+    }
+    return Sidecar{.file = std::move(file), .file_stat = file_stat, .encoding = {}};
 }
 
-void StaticFile::updateCache(const std::filesystem::path& path, const HttpResponse& builder) const {
-    try {
-        CacheEntry entry = {.builder = builder, .last_modified = last_write_time(path)};
+std::filesystem::path StaticFile::sidecarPath(const std::filesystem::path& path, const std::string_view suffix) {
+    std::filesystem::path sidecar = path;
+    sidecar += suffix;
+    return sidecar;
+}
 
-        std::lock_guard lock(cache_mutex_);
-        cache_[path] = std::move(entry);
-    } catch (const std::filesystem::filesystem_error& e) {
-        // 极端文件丢失情况
-        logger_->log(LogLevel::ERROR, std::format("updateCache failed: {} ({})", e.what(), path.string()));
+int StaticFile::watchFd() const {
+    return watcher_ ? watcher_->getFd() : -1;
+}
+
+void StaticFile::handleWatchEvents() {
+    try {
+        watcher_->handleEvents();
+    } catch (const std::runtime_error& e) {
+        // 部分变化可能已无法感知，退回到每次命中校验修改时间
+        watching_.store(false);
+        cache_.eraseUnder(root_);
+        fd_cache_.eraseUnder(root_);
+        LOG(logger_, LogLevel::ERROR, std::format("{} Falling back to mtime validation.", e.what()));
     }
 }
@@ -1,20 +1,85 @@
 #include "core/threadpool.h"
 
+#include <algorithm>
+#include <ctime>
 #include <format>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include <pthread.h>
 
 #include "utils/logger.h"
 
-ThreadPool::ThreadPool(const size_t thread_count, Logger* logger) : stop_(false), logger_(logger) {
-    // 创建并启动指定数量的线程
-    for (size_t i = 0; i < thread_count; ++i) {
-        workers_.emplace_back([this, i] { this->workerLoop(i); });
+namespace {
+    constexpr std::chrono::milliseconds ADJUST_INTERVAL{500};  // 负载采样与调整的周期
+    constexpr double GROW_QUEUE_WAIT_MS = 2.0;                 // 平均排队等待不低于该值视为拥塞
+    constexpr size_t GROW_AFTER_INTERVALS = 2;                 // 连续拥塞的周期数达到该值时增加线程
+    constexpr double SHRINK_UTILIZATION = 0.25;                // 利用率低于该值且没有排队视为空闲
+    constexpr size_t SHRINK_AFTER_INTERVALS = 10;              // 连续空闲的周期数达到该值后每个周期减少一个线程
+    constexpr double BLOCKING_CPU_RATIO = 0.5;                 // 执行时间中 CPU 占比低于该值视为以阻塞为主
+    constexpr size_t GROW_STEP_DIVISOR = 4;                    // 每次增加当前线程数的 1/4（至少一个）
+
+    // 当前线程所属的线程池与编号，工作线程提交的任务直接压入自己的队列
+    thread_local const ThreadPool* current_pool = nullptr;
+    thread_local size_t current_thread_id = 0;
+
+    uint64_t toNanoseconds(const std::chrono::steady_clock::duration duration) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+    }
+
+    // 线程累计占用的 CPU 时间，线程已退出等原因读取失败时返回 false
+    bool threadCpuTime(std::thread& thread, uint64_t& cpu_ns) {
+        clockid_t clock_id{};
+        timespec time{};
+        if (pthread_getcpuclockid(thread.native_handle(), &clock_id) != 0 || clock_gettime(clock_id, &time) != 0) {
+            return false;
+        }
+        constexpr uint64_t ns_per_second = 1000000000;
+        cpu_ns = static_cast<uint64_t>(time.tv_sec) * ns_per_second + static_cast<uint64_t>(time.tv_nsec);
+        return true;
+    }
+}  // namespace
+
+ThreadPool::ThreadPool(const ThreadPoolOptions& options, Logger* logger)
+    : min_threads_(std::clamp<size_t>(options.min_threads, options.threads > 0 ? 1 : 0, options.threads)),  // 至少保留一个线程
+      max_threads_(std::max(options.max_threads, options.threads)),
+      cpu_count_(std::max<size_t>(std::thread::hardware_concurrency(), 1)),
+      stop_(false),
+      logger_(logger) {
+    const size_t inbox_capacity = max_threads_ > 0 ? std::max<size_t>(options.queue_capacity / max_threads_, 1) : 0;
+    for (size_t i = 0; i < max_threads_; ++i) {
+        queues_.push_back(std::make_unique<Worker>(inbox_capacity));
+    }
+    workers_.resize(max_threads_);
+
+    // 创建并启动初始数量的线程（槽位需先全部创建，线程启动后即可能相互窃取）
+    {
+        std::lock_guard lock(resize_mutex_);
+        resize(options.threads);
+    }
+    LOG(logger_, LogLevel::INFO,
+        std::format("Thread pool started with {} threads (work stealing, queue capacity {}).",
+                    options.threads, max_threads_ > 0 ? queues_.front()->inbox.capacity() * max_threads_ : 0));
+
+    if (min_threads_ < max_threads_) {
+        LOG(logger_, LogLevel::INFO,
+            std::format("Thread pool adapts between {} and {} threads.", min_threads_, max_threads_));
+        last_sample_ = std::chrono::steady_clock::now();
+        controller_ = std::thread([this] { controlLoop(); });
     }
-    logger_->log(LogLevel::INFO, std::format("Thread pool started with {} threads.", thread_count));
 }
 
 ThreadPool::~ThreadPool() {
-    stop_ = true;
-    condition_.notify_all();
+    {
+        std::lock_guard lock(resize_mutex_);
+        stop_ = true;
+    }
+    control_cv_.notify_all();
+    if (controller_.joinable()) {
+        controller_.join();
+    }
+    idle_.notifyAll();
 
     // 等待所有线程结束
     for (std::thread& worker : workers_) {
@@ -22,47 +87,255 @@ ThreadPool::~ThreadPool() {
             worker.join();
         }
     }
+
+    // 释放停止期间仍被提交进来的任务（收件箱中的任务随队列析构）
+    for (const auto& queue : queues_) {
+        while (Job* job = queue->deque.pop()) {
+            delete job;  // NOLINT(cppcoreguidelines-owning-memory)
+        }
+    }
 }
 
-void ThreadPool::enqueue(std::function<void()> task) {
-    {
-        std::lock_guard lock(tasks_mutex_);
+bool ThreadPool::enqueue(InlineTask task) {
+    if (stop_) {
+        throw std::runtime_error("ThreadPool has been stopped. Cannot enqueue new tasks.");
+    }
+    if (queues_.empty()) {
+        throw std::runtime_error("ThreadPool has no worker threads.");
+    }
+
+    Job job{std::move(task), std::chrono::steady_clock::now()};
+    if (current_pool == this) {
+        queues_[current_thread_id]->deque.push(std::make_unique<Job>(std::move(job)).release());
+    } else {
+        // 从活跃槽位中的轮转位置开始依次尝试各收件箱（非活跃槽位的收件箱由其他线程窃取），全部已满时放弃
+        const size_t active = std::max<size_t>(active_.load(std::memory_order_relaxed), 1);
+        const size_t start = next_queue_.fetch_add(1, std::memory_order_relaxed) % active;
+        size_t attempt = 0;
+        while (!queues_[(start + attempt) % queues_.size()]->inbox.tryPush(job)) {
+            if (++attempt == queues_.size()) {
+                return false;
+            }
+        }
+    }
+    idle_.notifyOne();
+    return true;
+}
+
+ThreadPoolStats ThreadPool::stats() const {
+    ThreadPoolStats stats;
+    stats.threads = threadCount();
+    for (const auto& worker : queues_) {
+        stats.queued += worker->deque.size() + worker->inbox.size();
+        stats.tasks += worker->tasks.load(std::memory_order_relaxed);
+        stats.wait_ns += worker->wait_ns.load(std::memory_order_relaxed);
+        stats.busy_ns += worker->busy_ns.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+void ThreadPool::workerLoop(const size_t thread_id) {
+    current_pool = this;
+    current_thread_id = thread_id;
+
+    // 停止后仍先执行完已提交的任务，所有来源都为空时才退出
+    Job job;
+    while (true) {
+        // 被缩减的线程只处理自己的任务，不再窃取，处理完后退出
+        const bool retiring = thread_id >= active_.load(std::memory_order_acquire);
+        if (findTask(thread_id, job, !retiring)) {
+            runTask(job, thread_id);
+            continue;
+        }
         if (stop_) {
-            throw std::runtime_error("ThreadPool has been stopped. Cannot enqueue new tasks.");
+            break;
+        }
+        if (retiring) {
+            if (retire(thread_id)) {
+                break;
+            }
+            continue;
+        }
+
+        // 没有任务：登记为等待者后再检查一次，期间提交的任务不会被错过
+        const uint32_t key = idle_.prepareWait();
+        if (findTask(thread_id, job, true)) {
+            idle_.cancelWait();
+            runTask(job, thread_id);
+            continue;
+        }
+        if (stop_ || thread_id >= active_.load(std::memory_order_acquire)) {
+            idle_.cancelWait();
+            continue;
         }
-        tasks_.emplace(std::move(task));
+        idle_.wait(key);
     }
-    condition_.notify_one();
+    LOG(logger_, LogLevel::DEBUG, std::format("Thread {} exiting.", thread_id));
 }
 
-void ThreadPool::workerLoop(size_t thread_id) {
-    while (!stop_) {
-        std::function<void()> task;
+bool ThreadPool::findTask(const size_t thread_id, Job& job, const bool steal) {
+    Worker& self = *queues_[thread_id];
+    if (const std::unique_ptr<Job> local{self.deque.pop()}) {
+        job = std::move(*local);
+        return true;
+    }
+    if (self.inbox.tryPop(job)) {
+        return true;
+    }
+    if (!steal) {
+        return false;
+    }
 
-        {
-            std::unique_lock lock(tasks_mutex_);
+    // 从其他槽位窃取：先窃取队列，再取它们收件箱中的任务（所属线程可能正忙于长任务或已退出）
+    const size_t count = queues_.size();
+    for (size_t offset = 1; offset < count; ++offset) {
+        if (const std::unique_ptr<Job> stolen{queues_[(thread_id + offset) % count]->deque.steal()}) {
+            job = std::move(*stolen);
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < count; ++offset) {
+        if (queues_[(thread_id + offset) % count]->inbox.tryPop(job)) {
+            return true;
+        }
+    }
+    return false;
+}
 
-            // 等待任务队列不为空或线程池停止
-            condition_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+void ThreadPool::runTask(Job& job, const size_t thread_id) {
+    Worker& self = *queues_[thread_id];
+    const auto start = std::chrono::steady_clock::now();
+    self.wait_ns.fetch_add(toNanoseconds(start - job.enqueued), std::memory_order_relaxed);
 
-            // 如果已经停止且没有任务，退出线程
-            if (stop_ && tasks_.empty()) {
-                logger_->log(LogLevel::DEBUG, std::format("Thread {} exiting.", thread_id));
-                return;
-            }
+    // 执行任务
+    try {
+        job.task();
+    } catch (const std::exception& e) {
+        LOG(logger_, LogLevel::ERROR, std::format("Thread {} exception: {}", thread_id, e.what()));
+    } catch (...) {
+        LOG(logger_, LogLevel::ERROR, std::format("Thread {} unknown exception.", thread_id));
+    }
+
+    // 立即释放闭包捕获的资源（如连接的引用）
+    job.task.reset();
+
+    self.busy_ns.fetch_add(toNanoseconds(std::chrono::steady_clock::now() - start), std::memory_order_relaxed);
+    self.tasks.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool ThreadPool::retire(const size_t thread_id) {
+    std::lock_guard lock(resize_mutex_);
+    if (thread_id < active_.load(std::memory_order_relaxed)) {
+        return false;  // 退出前槽位又被重新启用
+    }
+    queues_[thread_id]->running = false;
+    return true;
+}
+
+void ThreadPool::controlLoop() {
+    std::unique_lock lock(resize_mutex_);
+    while (!control_cv_.wait_for(lock, ADJUST_INTERVAL, [this] { return stop_.load(); })) {
+        adjust(sampleLoad());
+    }
+}
 
-            // 取出一个任务
-            task = std::move(tasks_.front());
-            tasks_.pop();
+ThreadPool::LoadSample ThreadPool::sampleLoad() {
+    const auto now = std::chrono::steady_clock::now();
+    const uint64_t elapsed_ns = toNanoseconds(now - last_sample_);
+    last_sample_ = now;
+
+    uint64_t wait_ns = 0;
+    uint64_t busy_ns = 0;
+    uint64_t cpu_ns = 0;
+    uint64_t measured_busy_ns = 0;  // 成功读取了 CPU 时间的线程的执行时间
+    LoadSample sample;
+    for (size_t i = 0; i < queues_.size(); ++i) {
+        Worker& worker = *queues_[i];
+        const uint64_t tasks = worker.tasks.load(std::memory_order_relaxed);
+        const uint64_t worker_wait_ns = worker.wait_ns.load(std::memory_order_relaxed);
+        const uint64_t worker_busy_ns = worker.busy_ns.load(std::memory_order_relaxed);
+        const uint64_t busy_delta = worker_busy_ns - worker.sampled_busy_ns;
+        sample.tasks += tasks - worker.sampled_tasks;
+        wait_ns += worker_wait_ns - worker.sampled_wait_ns;
+        busy_ns += busy_delta;
+        worker.sampled_tasks = tasks;
+        worker.sampled_wait_ns = worker_wait_ns;
+        worker.sampled_busy_ns = worker_busy_ns;
+
+        uint64_t worker_cpu_ns = 0;
+        if (worker.running && threadCpuTime(workers_[i], worker_cpu_ns)) {
+            cpu_ns += worker_cpu_ns - std::min(worker.sampled_cpu_ns, worker_cpu_ns);
+            measured_busy_ns += busy_delta;
+            worker.sampled_cpu_ns = worker_cpu_ns;
+        }
+    }
+
+    constexpr double ns_per_ms = 1e6;
+    const size_t active = active_.load(std::memory_order_relaxed);
+    if (sample.tasks > 0) {
+        sample.avg_wait_ms = static_cast<double>(wait_ns) / static_cast<double>(sample.tasks) / ns_per_ms;
+    }
+    if (elapsed_ns > 0 && active > 0) {
+        sample.utilization = static_cast<double>(busy_ns) / static_cast<double>(elapsed_ns * active);
+    }
+    if (measured_busy_ns > 0) {
+        sample.cpu_ratio = std::min(static_cast<double>(cpu_ns) / static_cast<double>(measured_busy_ns), 1.0);
+    }
+    return sample;
+}
+
+void ThreadPool::adjust(const LoadSample& sample) {
+    if (sample.tasks > 0 && sample.avg_wait_ms >= GROW_QUEUE_WAIT_MS) {
+        ++congested_intervals_;
+        idle_intervals_ = 0;
+    } else if (sample.utilization < SHRINK_UTILIZATION) {
+        ++idle_intervals_;
+        congested_intervals_ = 0;
+    } else {
+        congested_intervals_ = 0;
+        idle_intervals_ = 0;
+    }
+
+    const size_t active = active_.load(std::memory_order_relaxed);
+    if (congested_intervals_ >= GROW_AFTER_INTERVALS && active < max_threads_) {
+        congested_intervals_ = 0;
+
+        // 任务以阻塞为主（如读取冷数据）时增加线程可以重叠等待；以计算为主时超过 CPU 核数只会增加切换开销
+        const size_t limit = sample.cpu_ratio < BLOCKING_CPU_RATIO ? max_threads_ : std::min(max_threads_, cpu_count_);
+        if (active < limit) {
+            const size_t count = std::min(limit, active + std::max<size_t>(active / GROW_STEP_DIVISOR, 1));
+            LOG(logger_, LogLevel::INFO,
+                std::format("Thread pool grows to {} threads (queue wait {:.2f} ms, utilization {:.0f}%, "
+                            "cpu {:.0f}%).",
+                            count, sample.avg_wait_ms, sample.utilization * 100, sample.cpu_ratio * 100));
+            resize(count);
         }
+    } else if (idle_intervals_ >= SHRINK_AFTER_INTERVALS && active > min_threads_) {
+        // 持续空闲后每个周期减少一个线程，直到负载回升或达到下限
+        LOG(logger_, LogLevel::INFO, std::format("Thread pool shrinks to {} threads (utilization {:.0f}%).",
+                                                 active - 1, sample.utilization * 100));
+        resize(active - 1);
+    }
+}
 
-        // 执行任务
-        try {
-            task();
-        } catch (const std::exception& e) {
-            logger_->log(LogLevel::ERROR, std::format("Thread {} exception: {}", thread_id, e.what()));
-        } catch (...) {
-            logger_->log(LogLevel::ERROR, std::format("Thread {} unknown exception.", thread_id));
+void ThreadPool::resize(const size_t count) {
+    const size_t previous = active_.load(std::memory_order_relaxed);
+    for (size_t i = previous; i < count; ++i) {
+        Worker& worker = *queues_[i];
+        if (worker.running) {
+            continue;  // 线程尚未退出，看到槽位重新活跃后会继续工作
+        }
+        if (workers_[i].joinable()) {
+            workers_[i].join();  // 已退出的线程，join 立即返回
         }
+        worker.running = true;
+        worker.sampled_cpu_ns = 0;
+        workers_[i] = std::thread([this, i] { this->workerLoop(i); });
+    }
+    active_.store(count, std::memory_order_release);
+
+    // 唤醒休眠的线程，被缩减的线程据此退出
+    if (count < previous) {
+        idle_.notifyAll();
     }
 }
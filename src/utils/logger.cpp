@@ -1,72 +1,161 @@
 #include "utils/logger.h"
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
 #include <chrono>
-#include <iomanip>
+#include <cstring>
+#include <ctime>
+#include <format>
 #include <iostream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "core/address.h"
 
-Logger::Logger(const LogLevel min_level) : min_level_(min_level) {
-    filename_ = generateLogFilename();
-    file_.open(filename_, std::ios::app);
-    if (!file_.is_open()) {
+// 单生产者单消费者的字节环形缓冲区：所属线程追加完整的日志行，后台线程整段取走。
+// 记录只在完整写入后才通过 head 发布，后台线程不会读到半条记录
+class LogRingBuffer {
+public:
+    explicit LogRingBuffer(const size_t capacity) : data_(std::bit_ceil(std::max<size_t>(capacity, 2))) {}
+
+    [[nodiscard]] size_t capacity() const { return data_.size(); }
+
+    // 已使用的字节数（生产者调用时准确，其他线程调用时只作参考）
+    [[nodiscard]] size_t used() const {
+        return head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_acquire);
+    }
+
+    // 追加一条记录（只能由所属线程调用），空间不足时返回 false
+    bool tryPush(const std::string_view line) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (line.size() > capacity() - (head - tail_.load(std::memory_order_acquire))) {
+            return false;
+        }
+        const size_t offset = head & (capacity() - 1);
+        const size_t first = std::min(line.size(), capacity() - offset);
+        std::memcpy(data_.data() + offset, line.data(), first);
+        std::memcpy(data_.data(), line.data() + first, line.size() - first);
+        head_.store(head + line.size(), std::memory_order_release);
+        return true;
+    }
+
+    // 取走全部已发布的记录追加到 out（只能由后台线程调用）
+    void drainTo(std::string& out) {
+        const size_t head = head_.load(std::memory_order_acquire);
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t offset = tail & (capacity() - 1);
+        const size_t first = std::min(head - tail, capacity() - offset);
+        out.append(data_.data() + offset, first);
+        out.append(data_.data(), head - tail - first);
+        tail_.store(head, std::memory_order_release);
+    }
+
+    // 所属线程退出后置位，缓冲区取空后由后台线程回收
+    void retire() { retired_.store(true, std::memory_order_release); }
+
+    [[nodiscard]] bool retired() const { return retired_.load(std::memory_order_acquire); }
+
+    size_t sample_count = 0;  // SAMPLE 策略的计数（只由所属线程访问）
+
+private:
+    std::vector<char> data_;
+    // NOLINTNEXTLINE(readability-magic-numbers, cppcoreguidelines-avoid-magic-numbers)
+    alignas(64) std::atomic<size_t> head_{0};
+    // NOLINTNEXTLINE(readability-magic-numbers, cppcoreguidelines-avoid-magic-numbers)
+    alignas(64) std::atomic<size_t> tail_{0};
+    std::atomic<bool> retired_{false};
+};
+
+namespace {
+    std::atomic<uint64_t> next_instance_id{1};
+
+    // 线程缓存的缓冲区，线程退出时标记缓冲区为已退出
+    struct ThreadBufferHandle {
+        uint64_t logger_id = 0;
+        std::shared_ptr<LogRingBuffer> buffer;
+
+        ThreadBufferHandle() = default;
+        ThreadBufferHandle(const ThreadBufferHandle&) = delete;
+        ThreadBufferHandle& operator=(const ThreadBufferHandle&) = delete;
+        ThreadBufferHandle(ThreadBufferHandle&&) = delete;
+        ThreadBufferHandle& operator=(ThreadBufferHandle&&) = delete;
+
+        ~ThreadBufferHandle() {
+            if (buffer) {
+                buffer->retire();
+            }
+        }
+    };
+
+    constexpr std::chrono::microseconds BLOCK_RETRY_INTERVAL{100};  // BLOCK 策略下等待后台线程腾出空间的间隔
+    constexpr size_t TIME_BUFFER_SIZE = 32;                         // 时间字符串缓冲区大小（YYYY-MM-DD HH:MM:SS）
+}  // namespace
+
+Logger::Logger(const LogLevel min_level, const LoggerOptions& options)
+    : min_level_(min_level),
+      options_(options),
+      instance_id_(next_instance_id.fetch_add(1, std::memory_order_relaxed)) {
+    filename_ = generateLogFilename(next_rotation_);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+    file_ = FileDescriptor(open(filename_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644));
+    if (!file_.valid()) {
         throw std::runtime_error("Failed to open log file " + filename_);
     }
-}
 
-Logger::~Logger() {
-    if (file_.is_open()) {
-        file_.close();
+    options_.sample_rate = std::max<size_t>(options_.sample_rate, 1);
+    if (options_.async) {
+        flusher_ = std::thread([this] { flushLoop(); });
     }
 }
 
-void Logger::log(const LogLevel level, const std::string& message) {
-    if (level < min_level_ || !file_.is_open()) {
+Logger::~Logger() {
+    if (!flusher_.joinable()) {
         return;
     }
 
-    try {
-        rotateIfNeeded();
-    } catch (const std::exception& e) {
-        std::cerr << "Logger::log(): Failed to rotate log file: " << e.what() << '\n';
-        return;
+    {
+        std::lock_guard lock(flush_mutex_);
+        stopping_ = true;
     }
+    flush_cv_.notify_one();
+    flusher_.join();
 
-    const std::string time = currentTime();
+    // 后台线程最后一次收集之后写入的记录
+    std::string batch;
+    drainBuffers(batch);
+    if (!batch.empty()) {
+        writeToFile(batch);
+    }
+}
 
-    std::lock_guard lock(mutex_);
+void Logger::log(const LogLevel level, const std::string& message) {
+    if (level < min_level_) {
+        return;
+    }
 
     // 写入日志格式：[YYYY-MM-DD HH:MM:SS] [LEVEL] message
-    file_ << std::format("[{}] [{}] {}", time, logLevelToString(level), message) << '\n';
-    file_.flush();
+    submit(level, std::format("[{}] [{}] {}\n", currentTime(), logLevelToString(level), message));
 }
 
 void Logger::log(const LogLevel level, const Address& address, const std::string& message) {
-    if (level < min_level_ || !file_.is_open()) {
-        return;
-    }
-
-    try {
-        rotateIfNeeded();
-    } catch (const std::exception& e) {
-        std::cerr << "Logger::log(): Failed to rotate log file: " << e.what() << '\n';
+    if (level < min_level_) {
         return;
     }
 
-    const std::string time = currentTime();
+    const std::string_view time = currentTime();
     const std::string client_info = address.toString();
     const int client_fd = address.fd();
 
-    std::lock_guard lock(mutex_);
-
     if (client_fd != -1) {
-        file_ << std::format("[{}] [{}] [Client {}] [fd: {}] {}", time, logLevelToString(level), client_info, client_fd,
-                             message)
-              << '\n';
+        submit(level, std::format("[{}] [{}] [Client {}] [fd: {}] {}\n", time, logLevelToString(level), client_info,
+                                  client_fd, message));
     } else {
-        file_ << std::format("[{}] [{}] [Client {}] {}", time, logLevelToString(level), client_info, message) << '\n';
+        submit(level, std::format("[{}] [{}] [Client {}] {}\n", time, logLevelToString(level), client_info, message));
     }
-    file_.flush();
 }
 
 void Logger::logDivider(const std::string& title, const LogLevel level) {
@@ -74,13 +163,150 @@ void Logger::logDivider(const std::string& title, const LogLevel level) {
     log(level, line);
 }
 
-std::string Logger::generateLogFilename() {
+void Logger::submit(const LogLevel level, const std::string_view line) {
+    if (options_.async) {
+        append(level, line);
+    } else {
+        writeToFile(line);
+    }
+}
+
+void Logger::append(const LogLevel level, const std::string_view line) {
+    LogRingBuffer& buffer = threadBuffer();
+    const size_t half = buffer.capacity() / 2;
+    if (line.size() > buffer.capacity()) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);  // 单条记录超过缓冲区容量，任何策略下都无法写入
+        return;
+    }
+
+    const size_t used = buffer.used();
+    if (options_.overflow == LogOverflowPolicy::SAMPLE && level < LogLevel::WARNING && used >= half &&
+        buffer.sample_count++ % options_.sample_rate != 0) {
+        sampled_out_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    while (!buffer.tryPush(line)) {
+        if (options_.overflow != LogOverflowPolicy::BLOCK || stopping_.load(std::memory_order_relaxed)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        flush_requested_.store(true, std::memory_order_relaxed);
+        flush_cv_.notify_one();
+        std::this_thread::sleep_for(BLOCK_RETRY_INTERVAL);
+    }
+
+    // 越过半满时提前唤醒后台线程（只在越过时通知一次，避免每条记录都产生系统调用）
+    if (used < half && used + line.size() >= half) {
+        flush_requested_.store(true, std::memory_order_relaxed);
+        flush_cv_.notify_one();
+    }
+}
+
+LogRingBuffer& Logger::threadBuffer() {
+    thread_local ThreadBufferHandle handle;
+    if (handle.logger_id != instance_id_) {
+        // 首次在本实例中写日志（或切换到了另一个实例）：创建缓冲区并登记
+        if (handle.buffer) {
+            handle.buffer->retire();
+        }
+        handle.buffer = std::make_shared<LogRingBuffer>(options_.buffer_bytes);
+        handle.logger_id = instance_id_;
+        std::lock_guard lock(buffers_mutex_);
+        buffers_.push_back(handle.buffer);
+    }
+    return *handle.buffer;
+}
+
+void Logger::flushLoop() {
+    std::string batch;
+    auto last_sync = std::chrono::steady_clock::now();
+    bool unsynced = false;
+
+    std::unique_lock lock(flush_mutex_);
+    while (true) {
+        flush_cv_.wait_for(lock, options_.flush_interval, [this] {
+            return stopping_.load(std::memory_order_relaxed) || flush_requested_.load(std::memory_order_relaxed);
+        });
+        const bool stopping = stopping_.load(std::memory_order_relaxed);
+        lock.unlock();
+
+        flush_requested_.store(false, std::memory_order_relaxed);
+        batch.clear();
+        drainBuffers(batch);
+
+        const uint64_t dropped = dropped_.exchange(0, std::memory_order_relaxed);
+        const uint64_t sampled_out = sampled_out_.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0 || sampled_out > 0) {
+            batch += std::format("[{}] [{}] Log buffer full: {} records dropped, {} records sampled out.\n",
+                                 currentTime(), logLevelToString(LogLevel::WARNING), dropped, sampled_out);
+        }
+
+        // 所有线程的记录合并为一次写入
+        if (!batch.empty()) {
+            writeToFile(batch);
+            unsynced = true;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (unsynced && options_.fsync_interval.count() > 0 &&
+            (stopping || now - last_sync >= options_.fsync_interval)) {
+            std::lock_guard file_lock(mutex_);
+            fdatasync(file_.get());
+            last_sync = now;
+            unsynced = false;
+        }
+
+        lock.lock();
+        if (stopping) {
+            break;
+        }
+    }
+}
+
+void Logger::drainBuffers(std::string& batch) {
+    std::lock_guard lock(buffers_mutex_);
+    std::erase_if(buffers_, [&batch](const std::shared_ptr<LogRingBuffer>& buffer) {
+        // 先读取退出标记再取数据：标记之前写入的记录都会在这次被取走
+        const bool retired = buffer->retired();
+        buffer->drainTo(batch);
+        return retired;
+    });
+}
+
+void Logger::writeToFile(std::string_view data) {
+    std::lock_guard lock(mutex_);
+    try {
+        rotateIfNeeded();
+    } catch (const std::exception& e) {
+        std::cerr << "Logger::log(): Failed to rotate log file: " << e.what() << '\n';
+        return;
+    }
+
+    while (!data.empty()) {
+        const ssize_t written = write(file_.get(), data.data(), data.size());
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "Logger::log(): Failed to write log file: " << std::strerror(errno) << '\n';
+            return;
+        }
+        data.remove_prefix(static_cast<size_t>(written));
+    }
+}
+
+std::string Logger::generateLogFilename(std::chrono::system_clock::time_point& next_rotation) {
     // 获取当前日期
     const auto now = std::chrono::system_clock::now();
-    const std::chrono::zoned_time local_time(std::chrono::current_zone(), now);
+    const std::chrono::time_zone* zone = std::chrono::current_zone();
+    const std::chrono::zoned_time local_time(zone, now);
     const auto today = std::chrono::floor<std::chrono::days>(local_time.get_local_time());
     const std::chrono::year_month_day ymd(today);
 
+    // 次日零点（夏令时切换导致零点不存在或重复时取较早的时刻）
+    next_rotation = zone->to_sys(today + std::chrono::days{1}, std::chrono::choose::earliest);
+
     const int year = static_cast<int>(ymd.year());
     const unsigned month = static_cast<unsigned>(ymd.month());
     const unsigned day = static_cast<unsigned>(ymd.day());
@@ -89,20 +315,22 @@ std::string Logger::generateLogFilename() {
 }
 
 void Logger::rotateIfNeeded() {
-    std::lock_guard lock(mutex_);
-    if (std::string filename = generateLogFilename(); filename_ != filename) {
-        if (file_.is_open()) {
-            file_.close();
+    // 只在越过次日零点时才重新计算文件名，平时只需比较一次时间
+    if (std::chrono::system_clock::now() < next_rotation_) {
+        return;
+    }
+    if (std::string filename = generateLogFilename(next_rotation_); filename_ != filename) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg, hicpp-vararg)
+        FileDescriptor file(open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644));
+        if (!file.valid()) {
+            throw std::runtime_error("Failed to open log file " + filename);  // 继续写入旧文件
         }
         filename_ = std::move(filename);
-        file_.open(filename_, std::ios::app);
-        if (!file_.is_open()) {
-            throw std::runtime_error("Failed to open log file " + filename_);
-        }
+        file_ = std::move(file);
     }
 }
 
-std::string Logger::logLevelToString(const LogLevel level) {
+std::string_view Logger::logLevelToString(const LogLevel level) {
     switch (level) {
         case LogLevel::DEBUG:
             return "DEBUG";
@@ -117,9 +345,18 @@ std::string Logger::logLevelToString(const LogLevel level) {
     }
 }
 
-std::string Logger::currentTime() {
+std::string_view Logger::currentTime() {
+    // 每个线程缓存格式化好的时间，同一秒内的日志直接复用，不再每条都调用 localtime_r 与格式化
+    thread_local std::time_t cached_second = -1;
+    thread_local std::array<char, TIME_BUFFER_SIZE> cached{};
+    thread_local size_t cached_length = 0;
+
     const std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-    std::ostringstream oss;
-    oss << std::put_time(std::localtime(&now), "%F %T");
-    return oss.str();
+    if (now != cached_second) {
+        std::tm local{};
+        localtime_r(&now, &local);
+        cached_length = std::strftime(cached.data(), cached.size(), "%F %T", &local);
+        cached_second = now;
+    }
+    return {cached.data(), cached_length};
 }
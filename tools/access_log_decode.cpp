@@ -0,0 +1,247 @@
+// 访问日志解码工具：将 AccessLog 写入的二进制访问日志（格式见 utils/access_log_format.h）解码为文本、CSV 或 JSON Lines，
+// 按文件内的顺序输出每条请求记录。文件末尾未写入的空间或进程异常退出时写了一半的记录会被忽略
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <exception>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <arpa/inet.h>
+
+#include "utils/access_log_format.h"
+
+namespace {
+    constexpr int64_t US_PER_SECOND = 1000000;
+
+    enum class OutputFormat : uint8_t {
+        TEXT,
+        CSV,
+        JSON,
+    };
+
+    // 解码出的一条请求
+    struct DecodedRequest {
+        int64_t time_us = 0;
+        std::string client_ip;
+        uint16_t client_port = 0;
+        std::string_view method;
+        std::string_view target;
+        uint16_t status = 0;
+        uint64_t bytes = 0;
+        uint32_t latency_us = 0;
+    };
+
+    std::string readFile(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error(std::format("Failed to open {}", path));
+        }
+        return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    }
+
+    // 格式化时间并附加微秒：utc 为 true 时输出 ISO 8601 的 UTC 时间，否则输出本地时间（与文本日志一致）
+    std::string formatTime(const int64_t time_us, const bool utc) {
+        const std::time_t seconds = time_us / US_PER_SECOND;
+        std::tm time{};
+        if (utc) {
+            gmtime_r(&seconds, &time);
+        } else {
+            localtime_r(&seconds, &time);
+        }
+        std::array<char, 32> buffer{};  // NOLINT(readability-magic-numbers, cppcoreguidelines-avoid-magic-numbers)
+        const size_t length = std::strftime(buffer.data(), buffer.size(), utc ? "%FT%T" : "%F %T", &time);
+        return std::format("{}.{:06}{}", std::string_view(buffer.data(), length), time_us % US_PER_SECOND,
+                           utc ? "Z" : "");
+    }
+
+    std::string formatIp(const uint32_t address) {
+        std::array<char, INET_ADDRSTRLEN> buffer{};
+        inet_ntop(AF_INET, &address, buffer.data(), buffer.size());
+        return buffer.data();
+    }
+
+    // CSV 字段：包含逗号、引号或换行时加引号，内部的引号写两次
+    std::string csvField(const std::string_view value) {
+        if (value.find_first_of(",\"\r\n") == std::string_view::npos) {
+            return std::string(value);
+        }
+        std::string result = "\"";
+        for (const char c : value) {  // NOLINT(readability-identifier-length)
+            if (c == '"') {
+                result += '"';
+            }
+            result += c;
+        }
+        return result + '"';
+    }
+
+    // JSON 字符串（含引号），转义引号、反斜杠与控制字符
+    std::string jsonString(const std::string_view value) {
+        std::string result = "\"";
+        for (const char c : value) {  // NOLINT(readability-identifier-length)
+            const auto byte = static_cast<unsigned char>(c);
+            if (c == '"' || c == '\\') {
+                result += '\\';
+                result += c;
+            } else if (byte < 0x20) {  // NOLINT(readability-magic-numbers, cppcoreguidelines-avoid-magic-numbers)
+                result += std::format("\\u{:04x}", byte);
+            } else {
+                result += c;
+            }
+        }
+        return result + '"';
+    }
+
+    void printRequest(const DecodedRequest& request, const OutputFormat format) {
+        switch (format) {
+            case OutputFormat::TEXT:
+                std::cout << std::format("{} {}:{} {} {} {} {} bytes {} us\n", formatTime(request.time_us, false),
+                                         request.client_ip, request.client_port,
+                                         request.method.empty() ? "-" : request.method,
+                                         request.target.empty() ? "-" : request.target, request.status, request.bytes,
+                                         request.latency_us);
+                break;
+            case OutputFormat::CSV:
+                std::cout << std::format("{},{},{},{},{},{},{},{}\n", formatTime(request.time_us, true),
+                                         request.client_ip, request.client_port, csvField(request.method),
+                                         csvField(request.target), request.status, request.bytes, request.latency_us);
+                break;
+            case OutputFormat::JSON:
+                std::cout << std::format(
+                    R"({{"time":"{}","client_ip":"{}","client_port":{},"method":{},"target":{},"status":{},)"
+                    R"("bytes":{},"latency_us":{}}})"
+                    "\n",
+                    formatTime(request.time_us, true), request.client_ip, request.client_port,
+                    jsonString(request.method), jsonString(request.target), request.status, request.bytes,
+                    request.latency_us);
+                break;
+        }
+    }
+
+    // 从 data 的 offset 处读取一个定长结构，剩余长度不足时返回 false
+    template <typename T>
+    bool readRecord(const std::string& data, const size_t offset, T& record) {
+        if (offset + sizeof(T) > data.size()) {
+            return false;
+        }
+        std::memcpy(&record, data.data() + offset, sizeof(T));
+        return true;
+    }
+
+    // 解码一个文件，返回解码出的请求数
+    size_t decodeFile(const std::string& path, const OutputFormat format) {
+        const std::string data = readFile(path);
+
+        AccessLogHeader header;
+        if (!readRecord(data, 0, header) || header.magic != AccessLogFormat::MAGIC) {
+            throw std::runtime_error(std::format("{} is not an access log", path));
+        }
+        if (header.version != AccessLogFormat::VERSION) {
+            throw std::runtime_error(std::format("{} has unsupported version {}", path, header.version));
+        }
+
+        std::vector<std::string> strings;  // 按编号保存的字符串
+        const auto lookup = [&strings](const uint32_t id) -> std::string_view {
+            return id < strings.size() ? std::string_view(strings[id]) : std::string_view("?");
+        };
+
+        int64_t time_us = header.base_time_us;
+        size_t offset = AccessLogFormat::align(sizeof(AccessLogHeader));
+        size_t count = 0;
+        while (offset < data.size()) {
+            const auto type = static_cast<AccessRecordType>(data[offset]);
+            if (type == AccessRecordType::END) {
+                break;
+            }
+
+            bool complete = false;
+            if (type == AccessRecordType::STRING) {
+                AccessStringRecord record;
+                // 编号按出现顺序依次分配，不连续说明记录已损坏
+                complete = readRecord(data, offset, record) && record.id == strings.size() &&
+                           offset + sizeof(record) + record.length <= data.size();
+                if (complete) {
+                    strings.emplace_back(data, offset + sizeof(record), record.length);
+                    offset += sizeof(record) + AccessLogFormat::align(record.length);
+                }
+            } else if (type == AccessRecordType::TIME) {
+                AccessTimeRecord record;
+                complete = readRecord(data, offset, record);
+                if (complete) {
+                    time_us = record.time_us;
+                    offset += sizeof(record);
+                }
+            } else if (type == AccessRecordType::REQUEST) {
+                AccessRequestRecord record;
+                complete = readRecord(data, offset, record);
+                if (complete) {
+                    time_us += record.time_delta_us;
+                    printRequest({.time_us = time_us,
+                                  .client_ip = formatIp(record.client_ip),
+                                  .client_port = record.client_port,
+                                  .method = lookup(record.method_id),
+                                  .target = lookup(record.path_id),
+                                  .status = record.status,
+                                  .bytes = record.bytes,
+                                  .latency_us = record.latency_us},
+                                 format);
+                    offset += sizeof(record);
+                    ++count;
+                }
+            } else {
+                std::cerr << std::format("{}: unknown record type {} at offset {}, stopping.\n", path,
+                                         static_cast<int>(type), offset);
+                break;
+            }
+
+            if (!complete) {
+                std::cerr << std::format("{}: truncated or corrupted record at offset {}, stopping.\n", path, offset);
+                break;
+            }
+        }
+        return count;
+    }
+}  // namespace
+
+int main(const int argc, char* argv[]) {
+    if (argc < 3) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        std::cerr << "Usage: " << argv[0] << " <text|csv|json> <access-log>...\n";
+        return 1;
+    }
+
+    const std::string_view format_name(argv[1]);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    OutputFormat format{};
+    if (format_name == "text") {
+        format = OutputFormat::TEXT;
+    } else if (format_name == "csv") {
+        format = OutputFormat::CSV;
+        std::cout << "time,client_ip,client_port,method,target,status,bytes,latency_us\n";
+    } else if (format_name == "json") {
+        format = OutputFormat::JSON;
+    } else {
+        std::cerr << std::format("Unknown format: {} (expected text, csv or json)\n", format_name);
+        return 1;
+    }
+
+    try {
+        size_t total = 0;
+        for (int i = 2; i < argc; ++i) {
+            total += decodeFile(argv[i], format);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        }
+        std::cerr << std::format("Decoded {} requests.\n", total);
+    } catch (const std::exception& e) {
+        std::cerr << "AccessLogDecode failed: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
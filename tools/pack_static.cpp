@@ -0,0 +1,322 @@
+// 打包工具：将静态目录打包为单个归档文件（格式见 utils/archive_format.h）。每个资源的 200 / 304 响应头在打包时
+// 按服务器相同的规则序列化好，文本资源同时存入 gzip（以及存在预压缩文件时的 br）表示，并为所有路径构建完美哈希，
+// 服务器启动时只需映射文件，无需遍历目录、读取文件或生成头部
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "core/http_response.h"
+#include "utils/archive_format.h"
+#include "utils/etag.h"
+#include "utils/gzip.h"
+#include "utils/http_date.h"
+#include "utils/mime_type.h"
+
+namespace {
+    // 预压缩文件的后缀（与 StaticFile 一致），打包时并入原文件的条目
+    constexpr std::array<std::string_view, 2> SIDECAR_SUFFIXES = {".gz", ".br"};
+
+    struct SourceFile {
+        std::filesystem::path path;  // 文件路径
+        std::string key;             // 相对于静态根目录的路径（以 / 分隔）
+    };
+
+    // 磁盘上的预压缩文件
+    struct Sidecar {
+        std::string data;  // 文件内容
+        std::string etag;  // 由预压缩文件自身状态生成的 ETag（与服务器直接读取预压缩文件时一致）
+    };
+
+    std::string readFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error(std::format("Failed to open {}", path.string()));
+        }
+        return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    }
+
+    struct stat statFile(const std::filesystem::path& path) {
+        struct stat file_stat {};
+        if (stat(path.c_str(), &file_stat) == -1) {
+            throw std::runtime_error(std::format("Failed to stat {}: {}", path.string(), strerror(errno)));
+        }
+        return file_stat;
+    }
+
+    // 读取未过期的预压缩文件（不是符号链接且不旧于原文件），不可用时返回空
+    std::optional<Sidecar> readSidecar(const std::filesystem::path& path, const struct stat& original) {
+        struct stat file_stat {};
+        if (lstat(path.c_str(), &file_stat) == -1 || !S_ISREG(file_stat.st_mode)) {
+            return std::nullopt;
+        }
+        const auto& sidecar_time = file_stat.st_mtim;
+        const auto& original_time = original.st_mtim;
+        if (sidecar_time.tv_sec < original_time.tv_sec ||
+            (sidecar_time.tv_sec == original_time.tv_sec && sidecar_time.tv_nsec < original_time.tv_nsec)) {
+            return std::nullopt;
+        }
+        return Sidecar{.data = readFile(path), .etag = ETag::fromStat(file_stat)};
+    }
+
+    // 是否为某个原文件的预压缩文件（原文件存在时并入其条目，不单独打包）
+    bool isSidecar(const std::filesystem::path& path) {
+        const std::filesystem::path extension = path.extension();
+        return std::ranges::find(SIDECAR_SUFFIXES, extension.native()) != SIDECAR_SUFFIXES.end() &&
+               std::filesystem::is_regular_file(path.parent_path() / path.stem());
+    }
+
+    // 为 keys 构建完美哈希的位移表，slots 返回每个键的槽位（hash and displace）：
+    // 先处理键最多的桶，为其搜索使所有键都落在空槽位上的种子；只有一个键的桶直接指定空槽位
+    std::vector<int32_t> buildDisplacements(const std::vector<SourceFile>& files, std::vector<size_t>& slots) {
+        const size_t count = files.size();
+        std::vector<std::vector<size_t>> buckets(count);
+        for (size_t i = 0; i < count; ++i) {
+            buckets[ArchiveFormat::hash(0, files[i].key) % count].push_back(i);
+        }
+
+        std::vector<size_t> order(count);
+        for (size_t i = 0; i < count; ++i) {
+            order[i] = i;
+        }
+        std::ranges::stable_sort(order, [&buckets](const size_t lhs, const size_t rhs) {
+            return buckets[lhs].size() > buckets[rhs].size();
+        });
+
+        std::vector<int32_t> displacements(count, 0);
+        std::vector<bool> occupied(count, false);
+        slots.assign(count, 0);
+        size_t free_slot = 0;
+        std::vector<size_t> candidates;
+
+        for (const size_t bucket : order) {
+            const std::vector<size_t>& keys = buckets[bucket];
+            if (keys.empty()) {
+                break;
+            }
+
+            if (keys.size() == 1) {
+                while (occupied[free_slot]) {
+                    ++free_slot;
+                }
+                occupied[free_slot] = true;
+                slots[keys.front()] = free_slot;
+                displacements[bucket] = -static_cast<int32_t>(free_slot) - 1;
+                continue;
+            }
+
+            for (uint32_t seed = 1;; ++seed) {
+                if (seed == static_cast<uint32_t>(std::numeric_limits<int32_t>::max())) {
+                    throw std::runtime_error("Failed to build the perfect hash table");
+                }
+
+                candidates.clear();
+                for (const size_t key : keys) {
+                    const size_t slot = ArchiveFormat::hash(seed, files[key].key) % count;
+                    if (occupied[slot] || std::ranges::find(candidates, slot) != candidates.end()) {
+                        break;
+                    }
+                    candidates.push_back(slot);
+                }
+                if (candidates.size() != keys.size()) {
+                    continue;
+                }
+
+                for (size_t i = 0; i < keys.size(); ++i) {
+                    occupied[candidates[i]] = true;
+                    slots[keys[i]] = candidates[i];
+                }
+                displacements[bucket] = static_cast<int32_t>(seed);
+                break;
+            }
+        }
+        return displacements;
+    }
+
+    // 顺序写入数据区并返回每段数据的区间
+    class ArchiveWriter {
+    public:
+        ArchiveWriter(const std::filesystem::path& path, const uint64_t data_offset)
+            : file_(path, std::ios::binary | std::ios::trunc), offset_(data_offset) {
+            if (!file_) {
+                throw std::runtime_error(std::format("Failed to create {}", path.string()));
+            }
+            file_.seekp(static_cast<std::streamoff>(offset_));
+        }
+
+        ArchiveSpan write(const std::string_view data) {
+            file_.write(data.data(), static_cast<std::streamsize>(data.size()));
+            const ArchiveSpan span{.offset = offset_, .length = data.size()};
+            offset_ += data.size();
+            return span;
+        }
+
+        // 在文件开头写入文件头、位移表与条目表
+        void finish(const ArchiveHeader& header, const std::vector<int32_t>& displacements,
+                    const std::vector<ArchiveEntry>& entries) {
+            writeAt(0, &header, sizeof(header));
+            writeAt(header.displacements_offset, displacements.data(), displacements.size() * sizeof(int32_t));
+            writeAt(header.entries_offset, entries.data(), entries.size() * sizeof(ArchiveEntry));
+            file_.close();
+            if (!file_) {
+                throw std::runtime_error("Failed to write the archive");
+            }
+        }
+
+    private:
+        std::ofstream file_;
+        uint64_t offset_;  // 数据区的写入位置
+
+        void writeAt(const uint64_t offset, const void* data, const size_t size) {
+            file_.seekp(static_cast<std::streamoff>(offset));
+            file_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        }
+    };
+
+    // 头部中指定字段的值在文件中的区间
+    ArchiveSpan headerValueSpan(const ArchiveSpan& header_span, const std::string_view header,
+                                const std::string_view name) {
+        const std::string prefix = std::format("\r\n{}: ", name);
+        const size_t start = header.find(prefix);
+        if (start == std::string_view::npos) {
+            return {};
+        }
+        const size_t value_start = start + prefix.size();
+        const size_t value_end = header.find("\r\n", value_start);
+        return {.offset = header_span.offset + value_start, .length = value_end - value_start};
+    }
+
+    // 写入一种表示：与 StaticFile 相同的公共头部，加上 Content-Encoding（非原始表示）与该表示的 ETag
+    ArchiveRepresentation writeRepresentation(ArchiveWriter& writer, HttpResponse builder, const std::string_view body,
+                                              const std::string& etag, const std::string_view encoding) {
+        if (!encoding.empty()) {
+            builder.addHeader("Content-Encoding", std::string(encoding));
+        }
+        builder.addHeader("ETag", etag);
+
+        const std::string header = builder.setStatus("200 OK").buildHeaderFields(body.size());
+        ArchiveRepresentation representation;
+        representation.header = writer.write(header);
+        representation.etag = headerValueSpan(representation.header, header, "ETag");
+        representation.content_type = headerValueSpan(representation.header, header, "Content-Type");
+        representation.not_modified =
+            writer.write(builder.setStatus("304 Not Modified").buildHeaderFields(body.size()));
+        representation.body = writer.write(body);
+        return representation;
+    }
+
+    // 写入一个资源的全部表示
+    ArchiveEntry writeEntry(ArchiveWriter& writer, const SourceFile& source) {
+        const struct stat file_stat = statFile(source.path);
+        const std::string data = readFile(source.path);
+        const std::string content_type = MimeType::get(source.path);
+        const bool compressible = data.size() >= Gzip::MIN_INPUT_SIZE && MimeType::isCompressible(content_type);
+
+        HttpResponse builder;
+        builder.setContentType(content_type)
+            .addHeader("Accept-Ranges", "bytes")
+            .addHeader("Last-Modified", HttpDate::format(file_stat.st_mtim.tv_sec));
+        if (compressible) {
+            builder.addHeader("Vary", "Accept-Encoding");
+        }
+
+        ArchiveEntry entry;
+        entry.path = writer.write(source.key);
+        entry.modified_time = file_stat.st_mtim.tv_sec;
+        const std::string etag = ETag::fromStat(file_stat);
+        entry.representations[ArchiveEntry::IDENTITY] = writeRepresentation(writer, builder, data, etag, {});
+        if (!compressible) {
+            return entry;
+        }
+
+        // 与服务器缓存的规则一致：优先使用未过期的预压缩文件，没有 gzip 预压缩文件时在此压缩（无收益时不存入）
+        std::filesystem::path brotli_path = source.path;
+        if (const auto brotli = readSidecar(brotli_path += ".br", file_stat)) {
+            entry.representations[ArchiveEntry::BROTLI] =
+                writeRepresentation(writer, builder, brotli->data, brotli->etag, "br");
+        }
+
+        std::filesystem::path gzip_path = source.path;
+        if (const auto gzip = readSidecar(gzip_path += ".gz", file_stat)) {
+            entry.representations[ArchiveEntry::GZIP] =
+                writeRepresentation(writer, builder, gzip->data, gzip->etag, "gzip");
+        } else if (const std::string compressed = Gzip::compress(data); compressed.size() < data.size()) {
+            entry.representations[ArchiveEntry::GZIP] =
+                writeRepresentation(writer, builder, compressed, ETag::withSuffix(etag, Gzip::ETAG_SUFFIX), "gzip");
+        }
+        return entry;
+    }
+
+    uint64_t alignUp(const uint64_t offset) {
+        return (offset + ArchiveFormat::ALIGNMENT - 1) / ArchiveFormat::ALIGNMENT * ArchiveFormat::ALIGNMENT;
+    }
+}  // namespace
+
+int main(const int argc, char* argv[]) {
+    if (argc != 3) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        std::cerr << "Usage: " << argv[0] << " <static-dir> <output>\n";
+        return 1;
+    }
+
+    try {
+        const std::filesystem::path root(argv[1]);    // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        const std::filesystem::path output(argv[2]);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+        // 只打包普通文件，符号链接可能指向根目录之外，交由服务器在运行时检查
+        std::vector<SourceFile> files;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(root)) {
+            if (!entry.is_regular_file() || entry.is_symlink() || isSidecar(entry.path())) {
+                continue;
+            }
+            files.push_back({.path = entry.path(), .key = entry.path().lexically_relative(root).generic_string()});
+        }
+        if (files.size() > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+            throw std::runtime_error("Too many files");
+        }
+
+        std::vector<size_t> slots;
+        const std::vector<int32_t> displacements = buildDisplacements(files, slots);
+
+        ArchiveHeader header;
+        header.magic = ArchiveFormat::MAGIC;
+        header.version = ArchiveFormat::VERSION;
+        header.entry_count = static_cast<uint32_t>(files.size());
+        header.displacements_offset = alignUp(sizeof(ArchiveHeader));
+        header.entries_offset = alignUp(header.displacements_offset + (files.size() * sizeof(int32_t)));
+
+        // 先写入临时文件再原子替换，运行中的服务器已映射的旧归档不受影响
+        std::filesystem::path temp = output;
+        temp += ".tmp";
+        ArchiveWriter writer(temp, header.entries_offset + (files.size() * sizeof(ArchiveEntry)));
+        std::vector<ArchiveEntry> entries(files.size());
+        for (size_t i = 0; i < files.size(); ++i) {
+            entries[slots[i]] = writeEntry(writer, files[i]);
+        }
+        writer.finish(header, displacements, entries);
+        std::filesystem::rename(temp, output);
+
+        std::cout << std::format("Packed {} files into {} ({} bytes).\n", files.size(), output.string(),
+                                 std::filesystem::file_size(output));
+    } catch (const std::exception& e) {
+        std::cerr << "Pack failed: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
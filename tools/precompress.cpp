@@ -0,0 +1,134 @@
+// 预压缩工具：遍历静态目录，为适合压缩的文本资源以最高压缩率生成 .gz（以及可用时的 .br）预压缩文件，
+// 服务器根据 Accept-Encoding 直接发送预压缩文件，请求路径上不再消耗 CPU 进行压缩
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#ifdef HAVE_BROTLI
+#include <brotli/encode.h>
+#endif
+
+#include "utils/gzip.h"
+#include "utils/mime_type.h"
+
+namespace {
+    std::string readFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error(std::format("Failed to open {}", path.string()));
+        }
+        return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    }
+
+    // 预压缩文件不旧于原文件时无需重新生成
+    bool isUpToDate(const std::filesystem::path& sidecar, const std::filesystem::path& original) {
+        std::error_code error;
+        const auto sidecar_time = last_write_time(sidecar, error);
+        return !error && sidecar_time >= last_write_time(original);
+    }
+
+    // 先写入临时文件再原子替换，运行中的服务器不会读到写了一半的文件；修改时间与原文件保持一致
+    void writeSidecar(const std::filesystem::path& sidecar, const std::string& data,
+                      const std::filesystem::path& original) {
+        std::filesystem::path temp = sidecar;
+        temp += ".tmp";
+        {
+            std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+            file.write(data.data(), static_cast<std::streamsize>(data.size()));
+            if (!file) {
+                throw std::runtime_error(std::format("Failed to write {}", temp.string()));
+            }
+        }
+        last_write_time(temp, last_write_time(original));
+        std::filesystem::rename(temp, sidecar);
+    }
+
+#ifdef HAVE_BROTLI
+    std::optional<std::string> brotliCompress(const std::string_view data) {
+        size_t encoded_size = BrotliEncoderMaxCompressedSize(data.size());
+        std::string output(encoded_size, '\0');
+        // NOLINTBEGIN(cppcoreguidelines-pro-type-reinterpret-cast)
+        if (BrotliEncoderCompress(BROTLI_MAX_QUALITY, BROTLI_DEFAULT_WINDOW, BROTLI_MODE_TEXT, data.size(),
+                                  reinterpret_cast<const uint8_t*>(data.data()), &encoded_size,
+                                  reinterpret_cast<uint8_t*>(output.data())) == BROTLI_FALSE) {
+            return std::nullopt;
+        }
+        // NOLINTEND(cppcoreguidelines-pro-type-reinterpret-cast)
+        output.resize(encoded_size);
+        return output;
+    }
+#endif
+
+    // 生成单个预压缩文件，压缩无收益时删除已有的旧文件，返回是否写入
+    bool precompress(const std::filesystem::path& original, const std::string& data, const std::string_view suffix,
+                     const std::optional<std::string>& compressed) {
+        std::filesystem::path sidecar = original;
+        sidecar += suffix;
+        if (!compressed || compressed->size() >= data.size()) {
+            std::filesystem::remove(sidecar);
+            return false;
+        }
+        writeSidecar(sidecar, *compressed, original);
+        return true;
+    }
+}  // namespace
+
+int main(const int argc, char* argv[]) {
+    if (argc != 2) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        std::cerr << "Usage: " << argv[0] << " <static-dir>\n";
+        return 1;
+    }
+
+    try {
+        const std::filesystem::path root(argv[1]);  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        size_t written = 0;
+        size_t skipped = 0;
+
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(root)) {
+            const std::filesystem::path& path = entry.path();
+            // 预压缩文件与临时文件的类型不可压缩，不会被重复处理
+            if (!entry.is_regular_file() || entry.is_symlink() || entry.file_size() < Gzip::MIN_INPUT_SIZE ||
+                !MimeType::isCompressible(MimeType::get(path))) {
+                continue;
+            }
+
+            bool up_to_date = isUpToDate(std::filesystem::path(path) += ".gz", path);
+#ifdef HAVE_BROTLI
+            up_to_date = up_to_date && isUpToDate(std::filesystem::path(path) += ".br", path);
+#endif
+            if (up_to_date) {
+                ++skipped;
+                continue;
+            }
+
+            const std::string data = readFile(path);
+            if (precompress(path, data, ".gz", Gzip::compress(data, Z_BEST_COMPRESSION))) {
+                std::cout << std::format("gzip   {}.gz\n", path.string());
+                ++written;
+            }
+#ifdef HAVE_BROTLI
+            if (precompress(path, data, ".br", brotliCompress(data))) {
+                std::cout << std::format("brotli {}.br\n", path.string());
+                ++written;
+            }
+#endif
+        }
+
+        std::cout << std::format("Precompressed {} files, {} up to date.\n", written, skipped);
+    } catch (const std::exception& e) {
+        std::cerr << "Precompress failed: " << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}